@@ -0,0 +1,295 @@
+#include "codec.h"
+
+#include <plog/Log.h>
+
+#include <cerrno>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+
+#include "../utils/config.h"
+#include "../utils/utils.h"
+
+namespace codecs {
+
+// zstd long distance matching window (log2, zstd --long 기본값)
+static constexpr int ZSTD_LONG_WINDOW_LOG = 27;
+
+static int defaultLevel(Codec codec) {
+  switch (codec) {
+    case Codec::Gzip:
+      return Config::GZIP_LEVEL;
+    case Codec::Zstd:
+      return Config::ZSTD_LEVEL;
+    case Codec::Lz4:
+      return Config::LZ4_LEVEL;
+    case Codec::None:
+      return 0;
+  }
+  return 0;
+}
+
+static int maxLevel(Codec codec) {
+  switch (codec) {
+    case Codec::Gzip:
+      return 9;
+    case Codec::Zstd:
+      return 19;
+    case Codec::Lz4:
+      return 9;
+    case Codec::None:
+      return 0;
+  }
+  return 0;
+}
+
+static int parseInt(const std::string& value, const char* error) {
+  try {
+    size_t idx = 0;
+    int parsed = std::stoi(value, &idx);
+    if (idx != value.size()) {
+      throw std::invalid_argument(error);
+    }
+    return parsed;
+  } catch (const std::exception&) {
+    throw std::invalid_argument(error);
+  }
+}
+
+// 요청 형식(JSON body, query string)과 무관한 option 파싱
+static CodecOptions parseOptions(
+    const std::function<std::string(const std::string&)>& get) {
+  CodecOptions options;
+
+  std::string name = get("codec");
+  if (!name.empty()) {
+    bool found = false;
+    for (Codec codec : ALL_CODECS) {
+      if (name == codecName(codec)) {
+        options.codec = codec;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      throw std::invalid_argument("Invalid codec");
+    }
+  }
+
+  options.level = defaultLevel(options.codec);
+  std::string level = get("level");
+  if (!level.empty() && options.codec != Codec::None) {
+    options.level = parseInt(level, "Invalid level");
+    if (options.level < 1 || options.level > maxLevel(options.codec)) {
+      throw std::invalid_argument("Level out of range");
+    }
+  }
+
+  std::string long_range = get("long");
+  if (!long_range.empty()) {
+    if (long_range != "true" && long_range != "false") {
+      throw std::invalid_argument("Invalid long");
+    }
+    options.long_range = long_range == "true";
+  }
+
+  options.threads = Config::COMPRESS_THREADS;
+  std::string threads = get("threads");
+  if (!threads.empty()) {
+    int parsed = parseInt(threads, "Invalid threads");
+    if (parsed < 0 || parsed > static_cast<int>(Config::MAX_COMPRESS_THREADS)) {
+      throw std::invalid_argument("Threads out of range");
+    }
+    options.threads = static_cast<size_t>(parsed);
+  }
+
+  std::string read_order = get("read_order");
+  if (read_order == "inode") {
+    options.read_order = utils::ReadOrder::Inode;
+  } else if (read_order == "extent") {
+    options.read_order = utils::ReadOrder::Extent;
+  } else if (!read_order.empty() && read_order != "name") {
+    throw std::invalid_argument("Invalid read_order");
+  }
+
+  // Snapshot id: 16자리 소문자 hex
+  options.base = get("base");
+  if (!options.base.empty() &&
+      (options.base.size() != 16 ||
+       options.base.find_first_not_of("0123456789abcdef") !=
+           std::string::npos)) {
+    throw std::invalid_argument("Invalid base");
+  }
+
+  std::string members = get("members");
+  if (!members.empty()) {
+    if (members != "true" && members != "false") {
+      throw std::invalid_argument("Invalid members");
+    }
+    options.members = members == "true";
+  }
+  if (options.members && options.codec != Codec::Gzip &&
+      options.codec != Codec::Zstd) {
+    throw std::invalid_argument("members requires gzip or zstd");
+  }
+  if (options.members && !options.base.empty()) {
+    throw std::invalid_argument("members cannot be combined with base");
+  }
+
+  std::string exclude = get("exclude");
+  size_t start = 0;
+  while (!exclude.empty() && start <= exclude.size()) {
+    size_t end = exclude.find(',', start);
+    if (end == std::string::npos) {
+      end = exclude.size();
+    }
+    if (end > start) {
+      options.exclude.push_back(exclude.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  if (options.exclude.size() > Config::MAX_EXCLUDE_PATTERNS) {
+    throw std::invalid_argument("Too many exclude patterns");
+  }
+
+  return options;
+}
+
+CodecOptions parseCodecOptions(const std::string& body) {
+  return parseOptions([&body](const std::string& key) {
+    return utils::extractJson(body, key);
+  });
+}
+
+CodecOptions parseCodecQuery(const std::string& query) {
+  return parseOptions([&query](const std::string& key) {
+    return utils::queryParam(query, key);
+  });
+}
+
+const char* codecName(Codec codec) {
+  switch (codec) {
+    case Codec::Gzip:
+      return "gzip";
+    case Codec::Zstd:
+      return "zstd";
+    case Codec::Lz4:
+      return "lz4";
+    case Codec::None:
+      return "none";
+  }
+  return "unknown";
+}
+
+const char* codecExtension(Codec codec) {
+  switch (codec) {
+    case Codec::Gzip:
+      return ".tgz";
+    case Codec::Zstd:
+      return ".tar.zst";
+    case Codec::Lz4:
+      return ".tar.lz4";
+    case Codec::None:
+      return ".tar";
+  }
+  return ".tar";
+}
+
+const char* codecContentType(Codec codec) {
+  switch (codec) {
+    case Codec::Gzip:
+      return "application/gzip";
+    case Codec::Zstd:
+      return "application/zstd";
+    case Codec::Lz4:
+      return "application/x-lz4";
+    case Codec::None:
+      return "application/x-tar";
+  }
+  return "application/octet-stream";
+}
+
+ArchiveOutput::ArchiveOutput(const CodecOptions& options, Sink sink)
+    : options(options), sink(std::move(sink)) {}
+
+void ArchiveOutput::open(archive* a) {
+  // gzip: block 단위 병렬 압축 (pigz 방식)
+  if (options.codec == Codec::Gzip) {
+    gzip = std::make_unique<ParallelGzipWriter>(sink, options.level,
+                                                options.threads);
+    if (gzip->open(a) != ARCHIVE_OK) {
+      throw std::runtime_error("Failed to open output");
+    }
+    return;
+  }
+
+  int r = ARCHIVE_OK;
+  if (options.codec == Codec::Zstd) {
+    r = archive_write_add_filter_zstd(a);
+  } else if (options.codec == Codec::Lz4) {
+    r = archive_write_add_filter_lz4(a);
+  } else {
+    r = archive_write_add_filter_none(a);
+  }
+  if (r != ARCHIVE_OK) {
+    throw std::runtime_error(std::string("Codec not supported: ") +
+                             codecName(options.codec));
+  }
+
+  const char* filter = codecName(options.codec);
+  if (options.codec != Codec::None) {
+    std::string level = std::to_string(options.level);
+    if (archive_write_set_filter_option(a, filter, "compression-level",
+                                        level.c_str()) != ARCHIVE_OK) {
+      throw std::runtime_error("Failed to set compression level: " +
+                               std::string(archive_error_string(a)));
+    }
+  }
+
+  // 구버전 libarchive에서 지원하지 않는 option은 경고만 남김
+  if (options.codec == Codec::Zstd) {
+    std::string threads =
+        std::to_string(ParallelGzipWriter::resolveThreads(options.threads));
+    if (archive_write_set_filter_option(a, filter, "threads",
+                                        threads.c_str()) != ARCHIVE_OK) {
+      PLOGW << "zstd threads option not supported";
+    }
+
+    if (options.long_range) {
+      std::string window = std::to_string(ZSTD_LONG_WINDOW_LOG);
+      if (archive_write_set_filter_option(a, filter, "long", window.c_str()) !=
+          ARCHIVE_OK) {
+        PLOGW << "zstd long option not supported";
+      }
+    }
+  }
+
+  // 압축된 stream 뒤에 block padding(0)이 붙지 않도록 함
+  archive_write_set_bytes_in_last_block(a, 1);
+
+  if (archive_write_open(a, this, nullptr, writeCallback, nullptr) !=
+      ARCHIVE_OK) {
+    throw std::runtime_error("Failed to open output: " +
+                             std::string(archive_error_string(a)));
+  }
+}
+
+void ArchiveOutput::cancel() {
+  if (gzip) {
+    gzip->cancel();
+  }
+}
+
+la_ssize_t ArchiveOutput::writeCallback(archive* a, void* client_data,
+                                        const void* buffer, size_t length) {
+  auto* self = static_cast<ArchiveOutput*>(client_data);
+  try {
+    self->sink(static_cast<const char*>(buffer), length);
+    return static_cast<la_ssize_t>(length);
+  } catch (const std::exception& e) {
+    archive_set_error(a, EIO, "%s", e.what());
+    return -1;
+  }
+}
+
+}  // namespace codecs
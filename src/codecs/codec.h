@@ -0,0 +1,76 @@
+#pragma once
+
+#include <archive.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../utils/filePrefetcher.h"
+#include "parallelGzip.h"
+
+namespace codecs {
+
+enum class Codec { Gzip, Zstd, Lz4, None };
+
+inline constexpr Codec ALL_CODECS[] = {Codec::Gzip, Codec::Zstd, Codec::Lz4,
+                                       Codec::None};
+
+struct CodecOptions {
+  Codec codec = Codec::Gzip;
+  int level = 0;            // 0: codec 기본값
+  bool long_range = false;  // zstd long distance matching
+  size_t threads = 0;       // 0: Config::COMPRESS_THREADS
+
+  // Workspace file 읽기 순서 (eMMC/HDD는 inode/extent 순이 유리)
+  utils::ReadOrder read_order = utils::ReadOrder::Name;
+
+  // Incremental archive 기준 snapshot id (빈 값: 전체 archive)
+  std::string base;
+
+  // File 단위 member archive (gzip/zstd, 바뀌지 않은 member 재사용)
+  bool members = false;
+
+  // 제외할 gitignore 형식 pattern (요청에서는 ','로 구분)
+  std::vector<std::string> exclude;
+};
+
+// codec/level/long/threads/read_order/base/members/exclude 파싱
+// (잘못된 값은 invalid_argument)
+CodecOptions parseCodecOptions(const std::string& body);  // JSON body
+CodecOptions parseCodecQuery(const std::string& query);   // query string
+
+const char* codecName(Codec codec);
+
+// Output 파일 확장자 (.tgz, .tar.zst, .tar.lz4, .tar)
+const char* codecExtension(Codec codec);
+const char* codecContentType(Codec codec);
+
+// Codec에 맞는 압축 단계를 구성하고 압축된 byte를 sink로 전달
+// gzip은 ParallelGzipWriter, 나머지는 libarchive filter 사용
+class ArchiveOutput {
+ public:
+  using Sink = ParallelGzipWriter::Sink;
+
+  ArchiveOutput(const CodecOptions& options, Sink sink);
+
+  ArchiveOutput(const ArchiveOutput&) = delete;
+  ArchiveOutput& operator=(const ArchiveOutput&) = delete;
+
+  // archive format 설정 후 호출 (실패 시 예외)
+  void open(archive* a);
+
+  // 오류 처리 중 archive close 시 남은 data를 기록하지 않도록 함
+  void cancel();
+
+ private:
+  static la_ssize_t writeCallback(archive* a, void* client_data,
+                                  const void* buffer, size_t length);
+
+  CodecOptions options;
+  Sink sink;
+  std::unique_ptr<ParallelGzipWriter> gzip;
+};
+
+}  // namespace codecs
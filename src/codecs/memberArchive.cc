@@ -0,0 +1,357 @@
+#include "memberArchive.h"
+
+#include <archive_entry.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "../utils/config.h"
+
+namespace codecs {
+
+static constexpr size_t TAR_BLOCK_SIZE = 512;
+
+// Segment 하나를 독립된 member로 압축 (libarchive raw format + codec filter)
+static std::string compressSegment(const CodecOptions& options,
+                                   const std::string& input) {
+  std::string result;
+  archive* a = archive_write_new();
+  if (!a) {
+    throw std::runtime_error("Failed to create archive");
+  }
+
+  archive_entry* entry = archive_entry_new();
+  try {
+    int r = archive_write_set_format_raw(a);
+    if (r == ARCHIVE_OK) {
+      r = options.codec == Codec::Gzip ? archive_write_add_filter_gzip(a)
+                                       : archive_write_add_filter_zstd(a);
+    }
+    if (r != ARCHIVE_OK) {
+      throw std::runtime_error(std::string("Codec not supported: ") +
+                               codecName(options.codec));
+    }
+
+    std::string level = std::to_string(options.level);
+    if (archive_write_set_filter_option(a, codecName(options.codec),
+                                        "compression-level",
+                                        level.c_str()) != ARCHIVE_OK) {
+      throw std::runtime_error("Failed to set compression level: " +
+                               std::string(archive_error_string(a)));
+    }
+    archive_write_set_bytes_in_last_block(a, 1);
+
+    auto append = [](archive*, void* client_data, const void* buffer,
+                     size_t length) -> la_ssize_t {
+      static_cast<std::string*>(client_data)
+          ->append(static_cast<const char*>(buffer), length);
+      return static_cast<la_ssize_t>(length);
+    };
+    if (archive_write_open(a, &result, nullptr, append, nullptr) !=
+        ARCHIVE_OK) {
+      throw std::runtime_error("Failed to open output: " +
+                               std::string(archive_error_string(a)));
+    }
+
+    archive_entry_set_filetype(entry, AE_IFREG);
+    archive_entry_set_size(entry, static_cast<la_int64_t>(input.size()));
+    if (archive_write_header(a, entry) != ARCHIVE_OK ||
+        archive_write_data(a, input.data(), input.size()) < 0 ||
+        archive_write_close(a) != ARCHIVE_OK) {
+      throw std::runtime_error("Failed to compress segment: " +
+                               std::string(archive_error_string(a)));
+    }
+  } catch (...) {
+    archive_entry_free(entry);
+    archive_write_free(a);
+    throw;
+  }
+
+  archive_entry_free(entry);
+  archive_write_free(a);
+  return result;
+}
+
+MemberArchiveWriter::MemberArchiveWriter(const CodecOptions& options,
+                                         Sink sink, int previous_fd,
+                                         MemberIndex previous)
+    : options(options),
+      sink(std::move(sink)),
+      previousFd(previous_fd),
+      previous(std::move(previous)),
+      maxInFlight(ParallelGzipWriter::resolveThreads(options.threads) * 2),
+      pool(ParallelGzipWriter::resolveThreads(options.threads)) {
+  if (options.codec != Codec::Gzip && options.codec != Codec::Zstd) {
+    throw std::invalid_argument("members requires gzip or zstd");
+  }
+
+  // Block 단위로 모으지 않고 바로 out에 기록 (entry 경계에서 자르기 위함)
+  tar = archive_write_new();
+  if (!tar) {
+    throw std::runtime_error("Failed to create archive");
+  }
+  archive_write_set_format_pax_restricted(tar);
+  archive_write_set_bytes_per_block(tar, 0);
+  if (archive_write_open(tar, this, nullptr, tarCallback, nullptr) !=
+      ARCHIVE_OK) {
+    std::string error = archive_error_string(tar);
+    archive_write_free(tar);
+    throw std::runtime_error("Failed to open archive: " + error);
+  }
+}
+
+MemberArchiveWriter::~MemberArchiveWriter() {
+  if (tar) {
+    archive_write_free(tar);
+  }
+  // 남은 작업은 pool 소멸 시 완료됨 (결과는 버림)
+}
+
+la_ssize_t MemberArchiveWriter::tarCallback(archive*, void* client_data,
+                                            const void* buffer,
+                                            size_t length) {
+  auto* self = static_cast<MemberArchiveWriter*>(client_data);
+  self->out.append(static_cast<const char*>(buffer), length);
+  return static_cast<la_ssize_t>(length);
+}
+
+// 경로 + tar header에 영향을 주는 metadata + segment 번호
+// (inode/mtime/size가 같으면 내용도 같다고 가정)
+uint64_t MemberArchiveWriter::segmentKey(const std::string& path,
+                                         const struct stat& st,
+                                         uint64_t part) const {
+  utils::TreeHash hash;
+  hash.add(path);
+  uint64_t fields[] = {
+      static_cast<uint64_t>(st.st_mode),
+      static_cast<uint64_t>(st.st_size),
+      static_cast<uint64_t>(st.st_mtim.tv_sec),
+      static_cast<uint64_t>(st.st_mtim.tv_nsec),
+      static_cast<uint64_t>(st.st_ino),
+      static_cast<uint64_t>(st.st_uid),
+      static_cast<uint64_t>(st.st_gid),
+      part,
+  };
+  hash.add(fields, sizeof(fields));
+  return hash.value();
+}
+
+// 큰 file의 segment 수: header 1 + data MEMBER_SIZE 단위
+static uint64_t segmentCount(const struct stat& st) {
+  uint64_t size = static_cast<uint64_t>(st.st_size);
+  return 1 + (size + Config::MEMBER_SIZE - 1) / Config::MEMBER_SIZE;
+}
+
+static bool isLarge(const struct stat& st) {
+  return S_ISREG(st.st_mode) &&
+         static_cast<uint64_t>(st.st_size) >= Config::MEMBER_SIZE;
+}
+
+bool MemberArchiveWriter::reusable(const std::string& path,
+                                   const struct stat& st) const {
+  if (previousFd < 0 || !isLarge(st)) {
+    return false;
+  }
+  for (uint64_t part = 0; part < segmentCount(st); ++part) {
+    if (previous.count(segmentKey(path, st, part)) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void MemberArchiveWriter::writeHeader(const std::string& path,
+                                      const struct stat& st) {
+  archive_entry* entry = archive_entry_new();
+  if (!entry) {
+    throw std::runtime_error("Failed to create archive entry");
+  }
+  archive_entry_set_pathname(entry, path.c_str());
+  archive_entry_copy_stat(entry, &st);
+
+  int r = archive_write_header(tar, entry);
+  archive_entry_free(entry);
+  if (r != ARCHIVE_OK) {
+    throw std::runtime_error("Failed to write archive header");
+  }
+}
+
+void MemberArchiveWriter::add(const std::string& path, const struct stat& st,
+                              const Reader& read) {
+  const char* data;
+  size_t len;
+
+  if (!isLarge(st)) {
+    writeHeader(path, st);
+    if (S_ISREG(st.st_mode)) {
+      while (read(data, len)) {
+        if (archive_write_data(tar, data, len) < 0) {
+          throw std::runtime_error("Failed to write archive data");
+        }
+      }
+    }
+    if (archive_write_finish_entry(tar) != ARCHIVE_OK) {
+      throw std::runtime_error("Failed to finish archive entry");
+    }
+
+    // Group key: 포함된 entry key의 순서열
+    uint64_t key = segmentKey(path, st, 0);
+    groupKey.add(&key, sizeof(key));
+    ++groupEntries;
+
+    utils::TreeHash boundary;
+    boundary.add(path);
+    if (boundary.value() % Config::MEMBER_GROUP_SPREAD == 0 ||
+        out.size() >= Config::MEMBER_SIZE) {
+      cutGroup();
+    }
+    return;
+  }
+
+  // 큰 file은 독립된 segment로 (앞의 group과 섞이지 않도록 먼저 정리)
+  cutGroup();
+  uint64_t count = segmentCount(st);
+
+  if (reusable(path, st)) {
+    for (uint64_t part = 0; part < count; ++part) {
+      uint64_t key = segmentKey(path, st, part);
+      pushCopy(key, previous.at(key));
+    }
+    return;
+  }
+
+  writeHeader(path, st);
+  pushCompress(segmentKey(path, st, 0), true, std::move(out));
+  out.clear();
+
+  uint64_t part = 1;
+  while (read(data, len)) {
+    if (archive_write_data(tar, data, len) < 0) {
+      throw std::runtime_error("Failed to write archive data");
+    }
+    while (out.size() >= Config::MEMBER_SIZE) {
+      pushCompress(segmentKey(path, st, part++), true,
+                   out.substr(0, Config::MEMBER_SIZE));
+      out.erase(0, Config::MEMBER_SIZE);
+    }
+  }
+
+  // 읽는 중 file이 줄어든 경우 libarchive가 0으로 채움
+  if (archive_write_finish_entry(tar) != ARCHIVE_OK) {
+    throw std::runtime_error("Failed to finish archive entry");
+  }
+  while (!out.empty()) {
+    size_t n = std::min(out.size(), Config::MEMBER_SIZE);
+    // 마지막 segment는 padding까지 포함
+    if (out.size() - n < TAR_BLOCK_SIZE) {
+      n = out.size();
+    }
+    // File이 줄어 segment 수가 달라진 경우 초과분은 재사용하지 않음
+    bool indexed = part < count;
+    pushCompress(segmentKey(path, st, part), indexed, out.substr(0, n));
+    out.erase(0, n);
+    ++part;
+  }
+}
+
+void MemberArchiveWriter::cutGroup() {
+  if (groupEntries == 0) {
+    return;
+  }
+
+  uint64_t key = groupKey.value();
+  auto it = previous.find(key);
+  if (previousFd >= 0 && it != previous.end()) {
+    pushCopy(key, it->second);
+  } else {
+    pushCompress(key, true, std::move(out));
+  }
+
+  out.clear();
+  groupKey = utils::TreeHash();
+  groupEntries = 0;
+}
+
+void MemberArchiveWriter::pushCompress(uint64_t key, bool indexed,
+                                       std::string data) {
+  Pending item{key, indexed, false, {0, 0}, {}};
+  CodecOptions opts = options;
+  item.data = pool.submit([opts, data = std::move(data)]() {
+    return compressSegment(opts, data);
+  });
+  pending.push_back(std::move(item));
+
+  // 완료된 segment는 바로 출력하고, 메모리 사용량은 in-flight 수로 제한
+  while (!pending.empty() &&
+         (pending.size() > maxInFlight || pending.front().copy ||
+          pending.front().data.wait_for(std::chrono::seconds(0)) ==
+              std::future_status::ready)) {
+    emitFront();
+  }
+}
+
+void MemberArchiveWriter::pushCopy(uint64_t key, const MemberSegment& from) {
+  pending.push_back(Pending{key, true, true, from, {}});
+  while (!pending.empty() &&
+         (pending.size() > maxInFlight || pending.front().copy)) {
+    emitFront();
+  }
+}
+
+void MemberArchiveWriter::emitFront() {
+  Pending item = std::move(pending.front());
+  pending.pop_front();
+
+  uint64_t length = 0;
+  if (item.copy) {
+    std::vector<char> buf(std::min<uint64_t>(item.from.length,
+                                             Config::PREFETCH_CHUNK_SIZE));
+    while (length < item.from.length) {
+      size_t n = static_cast<size_t>(
+          std::min<uint64_t>(buf.size(), item.from.length - length));
+      ssize_t got = pread(previousFd, buf.data(), n,
+                          static_cast<off_t>(item.from.offset + length));
+      if (got < 0 && errno == EINTR) {
+        continue;
+      }
+      if (got <= 0) {
+        throw std::runtime_error("Failed to read previous archive");
+      }
+      sink(buf.data(), static_cast<size_t>(got));
+      length += static_cast<uint64_t>(got);
+    }
+  } else {
+    std::string data = item.data.get();
+    sink(data.data(), data.size());
+    length = data.size();
+  }
+
+  if (item.indexed) {
+    written[item.key] = MemberSegment{offset, length};
+  }
+  offset += length;
+}
+
+void MemberArchiveWriter::finish() {
+  cutGroup();
+
+  // End-of-archive block (index에 기록하지 않음)
+  if (archive_write_close(tar) != ARCHIVE_OK) {
+    throw std::runtime_error("Failed to finalize archive: " +
+                             std::string(archive_error_string(tar)));
+  }
+  archive_write_free(tar);
+  tar = nullptr;
+  pushCompress(0, false, std::move(out));
+  out.clear();
+
+  while (!pending.empty()) {
+    emitFront();
+  }
+}
+
+}  // namespace codecs
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <archive.h>
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include <unordered_map>
+
+#include "../utils/threadPool.h"
+#include "../utils/treeHash.h"
+#include "codec.h"
+
+namespace codecs {
+
+// 이전 archive에서 segment 위치 (segment key -> byte 범위)
+struct MemberSegment {
+  uint64_t offset;
+  uint64_t length;
+};
+using MemberIndex = std::unordered_map<uint64_t, MemberSegment>;
+
+// 독립적으로 압축한 member(gzip member / zstd frame)를 이어 붙인 tar archive
+// 이어 붙인 member는 표준 decoder로 하나의 stream처럼 풀리므로 일반 archive와
+// 호환되고, 바뀌지 않은 segment는 이전 archive의 압축된 byte를 그대로 복사
+//
+// Segment 구성 (같은 entry는 항상 같은 segment key):
+// - 작은 entry: 경로 hash 기준 경계까지 묶은 group (entry 추가/삭제 시
+//   해당 group만 바뀜)
+// - MEMBER_SIZE 이상 file: header 하나 + data MEMBER_SIZE 단위
+class MemberArchiveWriter {
+ public:
+  using Sink = ParallelGzipWriter::Sink;
+  using Reader = std::function<bool(const char*& data, size_t& len)>;
+
+  // previous_fd: 이전 archive (-1: 없음), previous: 그 index
+  MemberArchiveWriter(const CodecOptions& options, Sink sink,
+                      int previous_fd, MemberIndex previous);
+  ~MemberArchiveWriter();
+
+  MemberArchiveWriter(const MemberArchiveWriter&) = delete;
+  MemberArchiveWriter& operator=(const MemberArchiveWriter&) = delete;
+
+  // 이전 archive에서 복사할 큰 file인지 (true면 data를 읽을 필요 없음)
+  bool reusable(const std::string& path, const struct stat& st) const;
+
+  // Entry 추가 (reusable이면 read는 호출하지 않음)
+  void add(const std::string& path, const struct stat& st,
+           const Reader& read);
+
+  // 남은 segment와 end-of-archive 기록
+  void finish();
+
+  // 새 archive의 index (finish 이후 유효)
+  const MemberIndex& index() const { return written; }
+
+ private:
+  struct Pending {
+    uint64_t key;
+    bool indexed;  // index에 기록할 segment
+    bool copy;     // 이전 archive에서 복사
+    MemberSegment from;
+    std::future<std::string> data;
+  };
+
+  static la_ssize_t tarCallback(archive* a, void* client_data,
+                                const void* buffer, size_t length);
+
+  uint64_t segmentKey(const std::string& path, const struct stat& st,
+                      uint64_t part) const;
+  void writeHeader(const std::string& path, const struct stat& st);
+  void cutGroup();
+  void pushCompress(uint64_t key, bool indexed, std::string data);
+  void pushCopy(uint64_t key, const MemberSegment& from);
+  void emitFront();
+
+  CodecOptions options;
+  Sink sink;
+  int previousFd;
+  MemberIndex previous;
+  MemberIndex written;
+  uint64_t offset = 0;
+
+  archive* tar = nullptr;
+  std::string out;  // 아직 segment로 자르지 않은 tar byte
+  utils::TreeHash groupKey;
+  size_t groupEntries = 0;
+
+  size_t maxInFlight;
+  std::deque<Pending> pending;
+
+  // 소멸 시 진행 중인 압축 작업 완료를 기다리도록 마지막에 선언
+  utils::ThreadPool pool;
+};
+
+}  // namespace codecs
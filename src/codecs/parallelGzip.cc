@@ -0,0 +1,196 @@
+#include "parallelGzip.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+#include "../utils/config.h"
+
+namespace codecs {
+
+// Deflate window 크기 (dictionary로 넘길 최대 크기)
+static constexpr size_t DICT_SIZE = 32768;
+
+ParallelGzipWriter::ParallelGzipWriter(Sink sink, int level, size_t threads)
+    : sink(std::move(sink)),
+      level(level),
+      maxInFlight(resolveThreads(threads) * 2),
+      crc(crc32(0L, Z_NULL, 0)),
+      pool(resolveThreads(threads)) {
+  current.reserve(Config::GZIP_BLOCK_SIZE);
+}
+
+size_t ParallelGzipWriter::resolveThreads(size_t threads) {
+  if (threads > 0) {
+    return threads;
+  }
+  size_t cores = std::thread::hardware_concurrency();
+  return cores > 0 ? cores : 1;
+}
+
+ParallelGzipWriter::BlockResult ParallelGzipWriter::compressBlock(
+    const std::string& input, const std::string& dict, int level, bool last) {
+  z_stream strm = {};
+  // Raw deflate (header/trailer는 writer가 직접 작성)
+  if (deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    throw std::runtime_error("Failed to initialize deflate");
+  }
+
+  if (!dict.empty()) {
+    deflateSetDictionary(&strm, reinterpret_cast<const Bytef*>(dict.data()),
+                         static_cast<uInt>(dict.size()));
+  }
+
+  BlockResult result;
+  result.length = input.size();
+  result.crc = crc32(crc32(0L, Z_NULL, 0),
+                     reinterpret_cast<const Bytef*>(input.data()),
+                     static_cast<uInt>(input.size()));
+
+  // 마지막 block이 아니면 sync flush로 byte 경계 정렬 (final bit 없음)
+  int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+  result.data.resize(deflateBound(&strm, input.size()) + 16);
+
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  strm.avail_in = static_cast<uInt>(input.size());
+
+  size_t produced = 0;
+  while (true) {
+    strm.next_out = reinterpret_cast<Bytef*>(&result.data[produced]);
+    strm.avail_out = static_cast<uInt>(result.data.size() - produced);
+
+    int r = deflate(&strm, flush);
+    produced = result.data.size() - strm.avail_out;
+
+    if (r == Z_STREAM_ERROR) {
+      deflateEnd(&strm);
+      throw std::runtime_error("Deflate failed");
+    }
+    if ((last && r == Z_STREAM_END) || (!last && strm.avail_out > 0)) {
+      break;
+    }
+    result.data.resize(result.data.size() * 2);
+  }
+
+  deflateEnd(&strm);
+  result.data.resize(produced);
+  return result;
+}
+
+void ParallelGzipWriter::write(const void* data, size_t len) {
+  const char* p = static_cast<const char*>(data);
+  while (len > 0) {
+    size_t n = std::min(len, Config::GZIP_BLOCK_SIZE - current.size());
+    current.append(p, n);
+    p += n;
+    len -= n;
+
+    if (current.size() == Config::GZIP_BLOCK_SIZE) {
+      submitBlock(false);
+    }
+  }
+}
+
+void ParallelGzipWriter::submitBlock(bool last) {
+  if (!headerWritten) {
+    // gzip header: magic, deflate, flags 0, mtime 0, xfl 0, OS unix
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+    sink(header, sizeof(header));
+    headerWritten = true;
+  }
+
+  std::string input;
+  input.swap(current);
+  current.reserve(Config::GZIP_BLOCK_SIZE);
+
+  // 다음 block의 dictionary: 지금까지 입력의 마지막 32KB
+  std::string dict = dictionary;
+  if (input.size() >= DICT_SIZE) {
+    dictionary.assign(input, input.size() - DICT_SIZE, DICT_SIZE);
+  } else {
+    dictionary.append(input);
+    if (dictionary.size() > DICT_SIZE) {
+      dictionary.erase(0, dictionary.size() - DICT_SIZE);
+    }
+  }
+
+  int lvl = level;
+  pending.push_back(pool.submit(
+      [input = std::move(input), dict = std::move(dict), lvl, last]() {
+        return compressBlock(input, dict, lvl, last);
+      }));
+
+  // 완료된 block은 바로 출력하고, 메모리 사용량은 in-flight 수로 제한
+  while (!pending.empty() &&
+         (pending.size() > maxInFlight ||
+          pending.front().wait_for(std::chrono::seconds(0)) ==
+              std::future_status::ready)) {
+    emitFront();
+  }
+}
+
+void ParallelGzipWriter::emitFront() {
+  BlockResult result = pending.front().get();
+  pending.pop_front();
+
+  crc = crc32_combine(crc, result.crc, static_cast<z_off_t>(result.length));
+  totalIn += result.length;
+  sink(result.data.data(), result.data.size());
+}
+
+void ParallelGzipWriter::finish() {
+  if (finished) {
+    return;
+  }
+  finished = true;
+
+  submitBlock(true);
+  while (!pending.empty()) {
+    emitFront();
+  }
+
+  // gzip trailer: CRC32, ISIZE (little endian)
+  char trailer[8];
+  uint32_t isize = static_cast<uint32_t>(totalIn & 0xffffffffu);
+  for (int i = 0; i < 4; ++i) {
+    trailer[i] = static_cast<char>((crc >> (8 * i)) & 0xff);
+    trailer[4 + i] = static_cast<char>((isize >> (8 * i)) & 0xff);
+  }
+  sink(trailer, sizeof(trailer));
+}
+
+int ParallelGzipWriter::open(archive* a) {
+  return archive_write_open(a, this, nullptr, writeCallback, closeCallback);
+}
+
+la_ssize_t ParallelGzipWriter::writeCallback(archive* a, void* client_data,
+                                             const void* buffer,
+                                             size_t length) {
+  auto* self = static_cast<ParallelGzipWriter*>(client_data);
+  try {
+    self->write(buffer, length);
+    return static_cast<la_ssize_t>(length);
+  } catch (const std::exception& e) {
+    archive_set_error(a, EIO, "%s", e.what());
+    return -1;
+  }
+}
+
+int ParallelGzipWriter::closeCallback(archive* a, void* client_data) {
+  auto* self = static_cast<ParallelGzipWriter*>(client_data);
+  if (self->cancelled) {
+    return ARCHIVE_OK;
+  }
+  try {
+    self->finish();
+    return ARCHIVE_OK;
+  } catch (const std::exception& e) {
+    archive_set_error(a, EIO, "%s", e.what());
+    return ARCHIVE_FATAL;
+  }
+}
+
+}  // namespace codecs
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <archive.h>
+#include <zlib.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+
+#include "../utils/threadPool.h"
+
+namespace codecs {
+
+// pigz 방식 block 병렬 gzip
+// 입력을 고정 크기 block으로 나누어 독립적으로 deflate 하고 (직전 block의
+// 마지막 32KB를 dictionary로 사용) 순서대로 이어 붙여 단일 gzip member 생성
+class ParallelGzipWriter {
+ public:
+  // 압축된 byte를 받는 출력 (실패 시 예외)
+  using Sink = std::function<void(const char* data, size_t len)>;
+
+  ParallelGzipWriter(Sink sink, int level, size_t threads);
+
+  ParallelGzipWriter(const ParallelGzipWriter&) = delete;
+  ParallelGzipWriter& operator=(const ParallelGzipWriter&) = delete;
+
+  void write(const void* data, size_t len);
+  void finish();
+
+  // 오류 처리 중 archive close 시 남은 data를 기록하지 않도록 함
+  void cancel() { cancelled = true; }
+
+  // libarchive 출력으로 연결 (format 설정 후 호출)
+  int open(archive* a);
+
+  // 0: CPU core 수 사용
+  static size_t resolveThreads(size_t threads);
+
+ private:
+  struct BlockResult {
+    std::string data;
+    uLong crc;
+    size_t length;
+  };
+
+  void submitBlock(bool last);
+  void emitFront();
+
+  static BlockResult compressBlock(const std::string& input,
+                                   const std::string& dict, int level,
+                                   bool last);
+  static la_ssize_t writeCallback(archive* a, void* client_data,
+                                  const void* buffer, size_t length);
+  static int closeCallback(archive* a, void* client_data);
+
+  Sink sink;
+  int level;
+  size_t maxInFlight;
+
+  std::string current;
+  std::string dictionary;
+  std::deque<std::future<BlockResult>> pending;
+
+  uLong crc;
+  uint64_t totalIn = 0;
+  bool headerWritten = false;
+  bool finished = false;
+  bool cancelled = false;
+
+  // 소멸 시 진행 중인 block 작업 완료를 기다리도록 마지막에 선언
+  utils::ThreadPool pool;
+};
+
+}  // namespace codecs
@@ -1,22 +1,46 @@
 #include "httpController.h"
 
 #include <plog/Log.h>
-#include <unistd.h>
-
-#include <sstream>
 
 #include "../utils/config.h"
 #include "../utils/utils.h"
 
 namespace controllers {
 
-void HttpController::routeGetRequest(int client, const std::string& path) {
+void HttpController::routeGetRequest(int client, const std::string& path,
+                                     const std::string& query,
+                                     const server::HttpRequest& request) {
   // Route to RobotController
   if (path == "/api/robot/running") {
     robotController.handleRunning(client);
     return;
   }
 
+  // Route to WorkspaceController
+  if (path == "/api/workspace/archive") {
+    workspaceController.handleArchiveDownload(client, query);
+    return;
+  }
+
+  if (path == "/api/workspace/output") {
+    workspaceController.handleOutputDownload(
+        client, query, std::string(request.header("Range")),
+        std::string(request.header("If-Range")));
+    return;
+  }
+
+  if (path == "/api/workspace/snapshots") {
+    workspaceController.handleSnapshots(client, query);
+    return;
+  }
+
+  // Route to JobController
+  const std::string jobs_prefix = "/api/jobs/";
+  if (path.compare(0, jobs_prefix.size(), jobs_prefix) == 0) {
+    jobController.handleStatus(client, path.substr(jobs_prefix.size()));
+    return;
+  }
+
   // No matching route
   utils::sendHttpResponse(client, 404, utils::jsonMsg(false, "Not found"));
 }
@@ -34,41 +58,74 @@ void HttpController::routePostRequest(int client, const std::string& path,
     return;
   }
 
+  if (path == "/api/workspace/restore") {
+    workspaceController.handleRestore(client, body);
+    return;
+  }
+
+  if (path == "/api/workspace/store") {
+    workspaceController.handleStore(client, body);
+    return;
+  }
+
+  if (path == "/api/workspace/store/restore") {
+    workspaceController.handleStoreRestore(client, body);
+    return;
+  }
+
   // No matching route
   utils::sendHttpResponse(client, 404, utils::jsonMsg(false, "Not found"));
 }
 
-void HttpController::handleRequest(int client, const std::string& client_ip) {
-  char buf[Config::REQUEST_BUFFER_SIZE] = {0};
-  if (read(client, buf, sizeof(buf) - 1) <= 0) return;
+void HttpController::routePutRequest(int client, const std::string& path,
+                                     const std::string& query,
+                                     utils::BodyReader& body) {
+  // Route to WorkspaceController
+  if (path == "/api/workspace/archive") {
+    workspaceController.handleArchiveUpload(client, query, body);
+    return;
+  }
 
-  try {
-    std::string req(buf);
-    std::istringstream stream(req);
-    std::string method, path, line;
+  // No matching route
+  utils::sendHttpResponse(client, 404, utils::jsonMsg(false, "Not found"));
+}
 
-    // Parse request line
-    std::getline(stream, line);
-    std::istringstream(line) >> method >> path;
+void HttpController::handleRequest(int client, const std::string& client_ip,
+                                   const server::HttpRequest& request,
+                                   utils::BodyReader* body) {
+  try {
+    std::string path(request.path);
+    std::string query(request.query);
 
-    PLOGI << client_ip << " - " << method << " " << path;
+    PLOGI << client_ip << " - " << request.method << " " << path;
 
     // Route based on HTTP method
-    if (method == "GET") {
-      routeGetRequest(client, path);
+    if (request.method == "GET") {
+      routeGetRequest(client, path, query, request);
       return;
     }
 
-    if (method == "POST") {
-      // Skip headers
-      while (std::getline(stream, line) && line != "\r" && !line.empty()) {
+    if (request.method == "POST") {
+      routePostRequest(client, path, std::string(request.body));
+      return;
+    }
+
+    if (request.method == "PUT") {
+      // Body는 handler가 socket에서 직접 읽음 (streaming upload)
+      if (!body) {
+        utils::sendHttpResponse(client, 400,
+                                utils::jsonMsg(false, "Bad request"));
+        return;
       }
 
-      // Read body
-      std::string body;
-      std::getline(stream, body, '\0');
+      if (!request.chunked &&
+          request.contentLength > Config::MAX_ARCHIVE_SIZE) {
+        utils::sendHttpResponse(client, 413,
+                                utils::jsonMsg(false, "Archive too large"));
+        return;
+      }
 
-      routePostRequest(client, path, body);
+      routePutRequest(client, path, query, *body);
       return;
     }
 
@@ -2,6 +2,9 @@
 
 #include <string>
 
+#include "../server/httpParser.h"
+#include "../utils/bodyReader.h"
+#include "jobController.h"
 #include "robotController.h"
 #include "workspaceController.h"
 
@@ -9,13 +12,21 @@ namespace controllers {
 
 class HttpController {
  public:
-  void handleRequest(int client, const std::string& client_ip);
+  // body: streaming request(PUT)의 body reader, 그 외에는 nullptr
+  void handleRequest(int client, const std::string& client_ip,
+                     const server::HttpRequest& request,
+                     utils::BodyReader* body);
 
  private:
-  void routeGetRequest(int client, const std::string& path);
+  void routeGetRequest(int client, const std::string& path,
+                       const std::string& query,
+                       const server::HttpRequest& request);
   void routePostRequest(int client, const std::string& path,
                         const std::string& body);
+  void routePutRequest(int client, const std::string& path,
+                       const std::string& query, utils::BodyReader& body);
 
+  JobController jobController;
   RobotController robotController;
   WorkspaceController workspaceController;
 };
@@ -0,0 +1,28 @@
+#include "jobController.h"
+
+#include "../services/jobService.h"
+#include "../utils/utils.h"
+
+namespace controllers {
+
+void JobController::handleStatus(int client, const std::string& id) {
+  services::JobStatus status;
+  if (!services::JobService::find(id, status)) {
+    utils::sendHttpResponse(client, 404,
+                            utils::jsonMsg(false, "Job not found"));
+    return;
+  }
+
+  std::string data =
+      R"({"id":")" + status.id + R"(","type":")" + status.type +
+      R"(","user":")" + utils::jsonEscape(status.user) + R"(","state":")" +
+      services::JobService::stateName(status.state) +
+      R"(","bytes":)" + std::to_string(status.bytes) +
+      R"(,"elapsed_ms":)" + std::to_string(status.elapsed_ms) +
+      R"(,"message":")" + utils::jsonEscape(status.message) + R"("})";
+
+  utils::sendHttpResponse(client, 200,
+                          R"({"success":true,"data":)" + data + "}");
+}
+
+}  // namespace controllers
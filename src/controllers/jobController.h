@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+namespace controllers {
+
+class JobController {
+ public:
+  // GET /api/jobs/{id}
+  void handleStatus(int client, const std::string& id);
+};
+
+}  // namespace controllers
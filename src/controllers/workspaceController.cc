@@ -1,21 +1,127 @@
 #include "workspaceController.h"
 
+#include <plog/Log.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
+#include "../codecs/codec.h"
+#include "../services/jobService.h"
 #include "../services/workspaceService.h"
+#include "../utils/chunkedWriter.h"
+#include "../utils/config.h"
+#include "../utils/httpResponse.h"
 #include "../utils/utils.h"
 
 namespace controllers {
 
+// Job 접수 응답 (202)
+static void sendAccepted(int client, const std::string& job_id) {
+  utils::sendHttpResponse(
+      client, 202,
+      R"({"success":true,"message":"Accepted","data":{"id":")" + job_id +
+          R"("}})");
+}
+
+// sync: "metadata" ("true"), "content", 없거나 "false"면 전체 기록
+static services::SyncMode parseSync(const std::string& value) {
+  if (value.empty() || value == "false") {
+    return services::SyncMode::Off;
+  }
+  if (value == "metadata" || value == "true") {
+    return services::SyncMode::Metadata;
+  }
+  if (value == "content") {
+    return services::SyncMode::Content;
+  }
+  throw std::invalid_argument("Invalid sync");
+}
+
+enum class RangeResult { Full, Partial, Unsatisfiable };
+
+// Range: bytes=<start>-<end> | bytes=<start>- | bytes=-<suffix>
+// 단일 구간만 지원, 해석할 수 없는 형식은 전체 전송
+static RangeResult parseRange(const std::string& header, uint64_t size,
+                              uint64_t& start, uint64_t& length) {
+  const std::string prefix = "bytes=";
+  if (header.compare(0, prefix.size(), prefix) != 0 ||
+      header.find(',') != std::string::npos) {
+    return RangeResult::Full;
+  }
+
+  std::string spec = header.substr(prefix.size());
+  size_t dash = spec.find('-');
+  if (dash == std::string::npos) {
+    return RangeResult::Full;
+  }
+
+  auto parse = [](const std::string& str, uint64_t& value) {
+    if (str.empty() ||
+        str.find_first_not_of("0123456789") != std::string::npos) {
+      return false;
+    }
+    value = std::strtoull(str.c_str(), nullptr, 10);
+    return true;
+  };
+
+  std::string first = spec.substr(0, dash);
+  std::string last = spec.substr(dash + 1);
+  uint64_t a, b;
+
+  // 마지막 N byte
+  if (first.empty()) {
+    if (!parse(last, b)) {
+      return RangeResult::Full;
+    }
+    if (b == 0 || size == 0) {
+      return RangeResult::Unsatisfiable;
+    }
+    start = size > b ? size - b : 0;
+    length = size - start;
+    return RangeResult::Partial;
+  }
+
+  if (!parse(first, a)) {
+    return RangeResult::Full;
+  }
+  if (a >= size) {
+    return RangeResult::Unsatisfiable;
+  }
+
+  uint64_t end = size - 1;
+  if (!last.empty()) {
+    if (!parse(last, b) || b < a) {
+      return RangeResult::Full;
+    }
+    end = std::min(b, size - 1);
+  }
+
+  start = a;
+  length = end - a + 1;
+  return RangeResult::Partial;
+}
+
 void WorkspaceController::handleCompress(int client, const std::string& body) {
   try {
     std::string user = utils::validateUser(body);
+    codecs::CodecOptions options = codecs::parseCodecOptions(body);
 
-    std::string message = services::WorkspaceService::compress(user);
+    std::string job_id = services::JobService::submit(
+        "compress", user, [user, options](std::atomic<uint64_t>& progress) {
+          return services::WorkspaceService::compress(user, options, &progress);
+        });
 
-    utils::sendHttpResponse(client, 200, utils::jsonMsg(true, message));
+    sendAccepted(client, job_id);
   } catch (const std::invalid_argument& e) {
     utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
   } catch (const std::exception& e) {
     utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
   }
@@ -24,12 +130,255 @@ void WorkspaceController::handleCompress(int client, const std::string& body) {
 void WorkspaceController::handleExtract(int client, const std::string& body) {
   try {
     std::string user = utils::validateUser(body);
+    services::SyncMode sync = parseSync(utils::extractJson(body, "sync"));
+
+    std::string job_id = services::JobService::submit(
+        "extract", user, [user, sync](std::atomic<uint64_t>& progress) {
+          return services::WorkspaceService::extract(user, sync, &progress);
+        });
+
+    sendAccepted(client, job_id);
+  } catch (const std::invalid_argument& e) {
+    utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
+  } catch (const std::exception& e) {
+    utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
+  }
+}
+
+void WorkspaceController::handleStore(int client, const std::string& body) {
+  try {
+    std::string user = utils::validateUser(body);
+
+    std::string job_id = services::JobService::submit(
+        "store", user, [user](std::atomic<uint64_t>& progress) {
+          return services::WorkspaceService::store(user, &progress);
+        });
+
+    sendAccepted(client, job_id);
+  } catch (const std::invalid_argument& e) {
+    utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
+  } catch (const std::exception& e) {
+    utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
+  }
+}
+
+void WorkspaceController::handleStoreRestore(int client,
+                                             const std::string& body) {
+  try {
+    std::string user = utils::validateUser(body);
+    std::string id = utils::extractJson(body, "id");
+    if (id.empty()) {
+      throw std::invalid_argument("Missing id field");
+    }
+
+    std::string job_id = services::JobService::submit(
+        "store-restore", user, [user, id](std::atomic<uint64_t>& progress) {
+          return services::WorkspaceService::restoreStored(user, id,
+                                                           &progress);
+        });
+
+    sendAccepted(client, job_id);
+  } catch (const std::invalid_argument& e) {
+    utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
+  } catch (const std::exception& e) {
+    utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
+  }
+}
+
+void WorkspaceController::handleSnapshots(int client,
+                                          const std::string& query) {
+  try {
+    std::string user = utils::checkUser(utils::queryParam(query, "user"));
+
+    // 저장된 크기만 읽으므로 job과 동시에 조회 가능
+    std::vector<services::HistorySnapshot> snapshots =
+        services::WorkspaceService::listHistory(user);
+
+    std::string data = "[";
+    for (const services::HistorySnapshot& snapshot : snapshots) {
+      if (data.size() > 1) {
+        data += ',';
+      }
+      data += R"({"id":")" + snapshot.id +
+              R"(","files":)" + std::to_string(snapshot.files) +
+              R"(,"bytes":)" + std::to_string(snapshot.bytes) +
+              R"(,"disk":)" + std::to_string(snapshot.disk) + "}";
+    }
+    data += "]";
+
+    utils::sendHttpResponse(client, 200,
+                            R"({"success":true,"data":)" + data + "}");
+  } catch (const std::invalid_argument& e) {
+    utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
+  } catch (const std::exception& e) {
+    utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
+  }
+}
+
+void WorkspaceController::handleRestore(int client, const std::string& body) {
+  try {
+    std::string user = utils::validateUser(body);
+    std::string id = utils::extractJson(body, "id");
+    if (id.empty()) {
+      throw std::invalid_argument("Missing id field");
+    }
+
+    std::string job_id = services::JobService::submit(
+        "restore", user, [user, id](std::atomic<uint64_t>& progress) {
+          return services::WorkspaceService::restore(user, id, &progress);
+        });
+
+    sendAccepted(client, job_id);
+  } catch (const std::invalid_argument& e) {
+    utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
+  } catch (const std::exception& e) {
+    utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
+  }
+}
+
+void WorkspaceController::handleArchiveDownload(int client,
+                                                const std::string& query) {
+  std::unique_ptr<utils::ChunkedWriter> writer;
+  try {
+    std::string user = utils::checkUser(utils::queryParam(query, "user"));
+    codecs::CodecOptions options = codecs::parseCodecQuery(query);
+
+    services::JobService::UserLock lock(user);
+
+    writer = std::make_unique<utils::ChunkedWriter>(
+        client, codecs::codecContentType(options.codec),
+        std::string("workspace") + codecs::codecExtension(options.codec));
+
+    services::WorkspaceService::stream(
+        user, options, [&writer](const char* data, size_t len) {
+          writer->write(data, len);
+        });
+
+    writer->finish();
+  } catch (const std::invalid_argument& e) {
+    utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
+  } catch (const std::exception& e) {
+    // 전송 시작 후에는 status를 바꿀 수 없으므로 연결 종료로 알림
+    if (writer && writer->started()) {
+      PLOGE << "Archive stream aborted: " << e.what();
+      shutdown(client, SHUT_RDWR);
+      return;
+    }
+    utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
+  }
+}
+
+void WorkspaceController::handleOutputDownload(int client,
+                                               const std::string& query,
+                                               const std::string& range,
+                                               const std::string& if_range) {
+  services::OutputFile output;
+  bool sending = false;
+  try {
+    std::string user = utils::checkUser(utils::queryParam(query, "user"));
+
+    {
+      // 압축 중인 파일을 열지 않도록 job과 배타적으로 open
+      // (열린 fd는 이후 compress가 파일을 교체해도 그대로 유효)
+      services::JobService::UserLock lock(user);
+      if (!services::WorkspaceService::openOutput(user, output)) {
+        utils::sendHttpResponse(client, 404,
+                                utils::jsonMsg(false, "Output not found"));
+        return;
+      }
+    }
+
+    // ETag: size + mtime (파일이 바뀌면 이어받기 불가)
+    char etag[64];
+    snprintf(etag, sizeof(etag), "\"%llx-%llx\"",
+             static_cast<unsigned long long>(output.size),
+             static_cast<unsigned long long>(output.mtime_ns));
+
+    // If-Range가 현재 ETag와 다르면 전체 파일 전송
+    uint64_t start = 0;
+    uint64_t length = output.size;
+    RangeResult result = RangeResult::Full;
+    if (!range.empty() && (if_range.empty() || if_range == etag)) {
+      result = parseRange(range, output.size, start, length);
+    }
+
+    std::string total = std::to_string(output.size);
+    if (result == RangeResult::Unsatisfiable) {
+      utils::HttpResponse(416)
+          .header("Content-Type", "application/json")
+          .header("Content-Range", "bytes */" + total)
+          .body(utils::jsonMsg(false, "Range not satisfiable"))
+          .send(client);
+    } else {
+      utils::HttpResponse response(result == RangeResult::Partial ? 206
+                                                                  : 200);
+      response.header("Content-Type", codecs::codecContentType(output.codec))
+          .header("Content-Disposition",
+                  "attachment; filename=\"" + output.filename + "\"")
+          .header("Accept-Ranges", "bytes")
+          .header("ETag", etag);
+      if (result == RangeResult::Partial) {
+        response.header("Content-Range",
+                        "bytes " + std::to_string(start) + "-" +
+                            std::to_string(start + length - 1) + "/" + total);
+      }
+
+      sending = true;
+      response.file(output.fd, static_cast<off_t>(start), length)
+          .send(client);
+    }
+  } catch (const std::invalid_argument& e) {
+    utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
+  } catch (const std::exception& e) {
+    // 전송 시작 후에는 status를 바꿀 수 없으므로 연결 종료로 알림
+    if (sending) {
+      PLOGE << "Output download aborted: " << e.what();
+      shutdown(client, SHUT_RDWR);
+    } else {
+      utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
+    }
+  }
+
+  if (output.fd >= 0) {
+    close(output.fd);
+  }
+}
+
+void WorkspaceController::handleArchiveUpload(int client,
+                                              const std::string& query,
+                                              utils::BodyReader& body) {
+  try {
+    std::string user = utils::checkUser(utils::queryParam(query, "user"));
+    services::SyncMode sync = parseSync(utils::queryParam(query, "sync"));
+
+    services::JobService::UserLock lock(user);
+
+    std::string message = services::WorkspaceService::extractFrom(
+        user, [&body](char* buf, size_t len) { return body.read(buf, len); },
+        sync);
 
-    std::string message = services::WorkspaceService::extract(user);
+    // Archive 끝 이후의 남은 body 정리 (응답 전 RST 방지)
+    body.drain(Config::MAX_ARCHIVE_SIZE);
 
     utils::sendHttpResponse(client, 200, utils::jsonMsg(true, message));
   } catch (const std::invalid_argument& e) {
     utils::sendHttpResponse(client, 400, utils::jsonMsg(false, e.what()));
+  } catch (const services::JobConflictError& e) {
+    utils::sendHttpResponse(client, 409, utils::jsonMsg(false, e.what()));
   } catch (const std::exception& e) {
     utils::sendHttpResponse(client, 500, utils::jsonMsg(false, e.what()));
   }
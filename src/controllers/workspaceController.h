@@ -2,15 +2,41 @@
 
 #include <string>
 
+#include "../utils/bodyReader.h"
+
 namespace controllers {
 
 class WorkspaceController {
  public:
-  // POST /api/workspace/compress
+  // POST /api/workspace/compress (202 + job id)
   void handleCompress(int client, const std::string& body);
 
-  // POST /api/workspace/extract
+  // POST /api/workspace/extract (202 + job id)
   void handleExtract(int client, const std::string& body);
+
+  // GET /api/workspace/snapshots?user=... (history snapshot 목록)
+  void handleSnapshots(int client, const std::string& query);
+
+  // POST /api/workspace/restore {"user","id"} (202 + job id)
+  void handleRestore(int client, const std::string& body);
+
+  // POST /api/workspace/store (202 + job id)
+  void handleStore(int client, const std::string& body);
+
+  // POST /api/workspace/store/restore {"user","id"} (202 + job id)
+  void handleStoreRestore(int client, const std::string& body);
+
+  // GET /api/workspace/archive?user=... (chunked streaming)
+  void handleArchiveDownload(int client, const std::string& query);
+
+  // GET /api/workspace/output?user=... (sendfile, Range/If-Range 지원)
+  void handleOutputDownload(int client, const std::string& query,
+                            const std::string& range,
+                            const std::string& if_range);
+
+  // PUT /api/workspace/archive?user=... (body를 바로 해제)
+  void handleArchiveUpload(int client, const std::string& query,
+                           utils::BodyReader& body);
 };
 
 }  // namespace controllers
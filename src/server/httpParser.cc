@@ -0,0 +1,319 @@
+#include "httpParser.h"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "../utils/config.h"
+#include "../utils/utils.h"
+
+namespace server {
+
+// Chunk size/trailer line 최대 길이
+static constexpr size_t MAX_LINE_SIZE = 4096;
+
+static bool isSpace(char c) { return c == ' ' || c == '\t'; }
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+static bool containsToken(std::string_view value, std::string_view token) {
+  // Connection: keep-alive, Upgrade 같은 comma 구분 목록
+  size_t pos = 0;
+  while (pos < value.size()) {
+    size_t end = value.find(',', pos);
+    if (end == std::string_view::npos) {
+      end = value.size();
+    }
+    std::string_view item = value.substr(pos, end - pos);
+    while (!item.empty() && isSpace(item.front())) {
+      item.remove_prefix(1);
+    }
+    while (!item.empty() && isSpace(item.back())) {
+      item.remove_suffix(1);
+    }
+    if (equalsIgnoreCase(item, token)) {
+      return true;
+    }
+    pos = end + 1;
+  }
+  return false;
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+  for (const auto& h : headers) {
+    if (equalsIgnoreCase(h.first, name)) {
+      return h.second;
+    }
+  }
+  return {};
+}
+
+HttpParser::Result HttpParser::fail(int code, const char* message) {
+  status = code;
+  error = message;
+  return Result::Error;
+}
+
+HttpParser::Result HttpParser::parse(std::string& buffer) {
+  if (status != 0) {
+    return Result::Error;
+  }
+
+  if (phase == Phase::Headers) {
+    Result r = parseHeaders(buffer);
+    if (r != Result::Incomplete || phase == Phase::Headers) {
+      return r;
+    }
+  }
+
+  if (phase == Phase::Done) {
+    return streaming ? Result::HeadersComplete : Result::Complete;
+  }
+
+  if (phase == Phase::Length) {
+    if (buffer.size() - bodyStart < contentLength) {
+      return Result::Incomplete;
+    }
+    bodyEnd = bodyStart + contentLength;
+    rawPos = bodyEnd;
+    phase = Phase::Done;
+    return Result::Complete;
+  }
+
+  return parseChunked(buffer);
+}
+
+HttpParser::Result HttpParser::parseHeaders(const std::string& buffer) {
+  // Request 사이의 빈 줄 무시
+  while (rawPos + 1 < buffer.size() && buffer[rawPos] == '\r' &&
+         buffer[rawPos + 1] == '\n') {
+    rawPos += 2;
+  }
+
+  // 이전 호출에서 확인한 부분은 다시 검색하지 않음
+  size_t from = scanPos > rawPos + 3 ? scanPos - 3 : rawPos;
+  size_t end = buffer.find("\r\n\r\n", from);
+  if (end == std::string::npos) {
+    scanPos = buffer.size();
+    if (buffer.size() - rawPos > Config::MAX_HEADER_SIZE) {
+      return fail(413, "Request header too large");
+    }
+    return Result::Incomplete;
+  }
+  if (end - rawPos > Config::MAX_HEADER_SIZE) {
+    return fail(413, "Request header too large");
+  }
+
+  // Request line: METHOD SP TARGET SP VERSION
+  size_t line_end = buffer.find("\r\n", rawPos);
+  std::string_view line(buffer.data() + rawPos, line_end - rawPos);
+  size_t sp1 = line.find(' ');
+  size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+  if (sp1 == 0 || sp2 == std::string_view::npos || sp2 == sp1 + 1) {
+    return fail(400, "Bad request line");
+  }
+
+  method = {rawPos, sp1};
+  target = {rawPos + sp1 + 1, sp2 - sp1 - 1};
+  version = {rawPos + sp2 + 1, line.size() - sp2 - 1};
+
+  std::string_view ver(buffer.data() + version.pos, version.len);
+  if (ver != "HTTP/1.1" && ver != "HTTP/1.0") {
+    return fail(400, "Unsupported HTTP version");
+  }
+
+  // Header lines
+  size_t pos = line_end + 2;
+  while (pos < end + 2) {
+    size_t eol = buffer.find("\r\n", pos);
+    size_t colon = buffer.find(':', pos);
+    if (colon == std::string::npos || colon >= eol || colon == pos ||
+        isSpace(buffer[colon - 1])) {
+      return fail(400, "Bad header");
+    }
+    if (headers.size() >= Config::MAX_HEADER_COUNT) {
+      return fail(400, "Too many headers");
+    }
+
+    size_t vstart = colon + 1;
+    size_t vend = eol;
+    while (vstart < vend && isSpace(buffer[vstart])) {
+      ++vstart;
+    }
+    while (vend > vstart && isSpace(buffer[vend - 1])) {
+      --vend;
+    }
+
+    headers.push_back({{pos, colon - pos}, {vstart, vend - vstart}});
+    pos = eol + 2;
+  }
+
+  HttpRequest req = request(buffer);
+
+  std::string_view encoding = req.header("Transfer-Encoding");
+  if (!encoding.empty()) {
+    if (!equalsIgnoreCase(encoding, "chunked")) {
+      return fail(400, "Unsupported transfer encoding");
+    }
+    chunked = true;
+  }
+
+  std::string_view length = req.header("Content-Length");
+  if (!length.empty() && !chunked) {
+    contentLength = 0;
+    for (char c : length) {
+      if (c < '0' || c > '9' || contentLength > UINT64_MAX / 10 - 1) {
+        return fail(400, "Invalid content length");
+      }
+      contentLength = contentLength * 10 + static_cast<uint64_t>(c - '0');
+    }
+  }
+
+  std::string_view connection = req.header("Connection");
+  keepAlive = ver == "HTTP/1.1" ? !containsToken(connection, "close")
+                                : containsToken(connection, "keep-alive");
+
+  bodyStart = bodyEnd = end + 4;
+  rawPos = bodyStart;
+
+  // PUT: body는 handler가 socket에서 직접 읽음 (streaming upload)
+  if (req.method == "PUT") {
+    streaming = true;
+    phase = Phase::Done;
+    return Result::HeadersComplete;
+  }
+
+  if (chunked) {
+    phase = Phase::ChunkSize;
+  } else {
+    if (contentLength > Config::MAX_REQUEST_SIZE) {
+      return fail(413, "Request too large");
+    }
+    phase = Phase::Length;
+  }
+  return Result::Incomplete;
+}
+
+HttpParser::Result HttpParser::parseChunked(std::string& buffer) {
+  while (true) {
+    switch (phase) {
+      case Phase::ChunkSize: {
+        size_t eol = buffer.find("\r\n", rawPos);
+        if (eol == std::string::npos) {
+          if (buffer.size() - rawPos > MAX_LINE_SIZE) {
+            return fail(400, "Chunk line too long");
+          }
+          return Result::Incomplete;
+        }
+
+        // chunk-ext (;name=value)는 무시
+        uint64_t size;
+        if (!utils::parseChunkSize(buffer.c_str() + rawPos, eol - rawPos,
+                                   size)) {
+          return fail(400, "Invalid chunk size");
+        }
+
+        rawPos = eol + 2;
+        if (size == 0) {
+          phase = Phase::Trailer;
+          break;
+        }
+        if (size > Config::MAX_REQUEST_SIZE ||
+            bodyEnd - bodyStart + size > Config::MAX_REQUEST_SIZE) {
+          return fail(413, "Request too large");
+        }
+        chunkRemaining = size;
+        phase = Phase::ChunkData;
+        break;
+      }
+
+      case Phase::ChunkData: {
+        // Chunk data를 앞으로 당겨 body를 연속된 영역으로 만듦
+        size_t n = static_cast<size_t>(std::min<uint64_t>(
+            chunkRemaining, buffer.size() - rawPos));
+        if (n > 0 && bodyEnd != rawPos) {
+          memmove(&buffer[bodyEnd], &buffer[rawPos], n);
+        }
+        bodyEnd += n;
+        rawPos += n;
+        chunkRemaining -= n;
+        if (chunkRemaining > 0) {
+          return Result::Incomplete;
+        }
+        phase = Phase::ChunkEnd;
+        break;
+      }
+
+      case Phase::ChunkEnd:
+        if (buffer.size() - rawPos < 2) {
+          return Result::Incomplete;
+        }
+        if (buffer[rawPos] != '\r' || buffer[rawPos + 1] != '\n') {
+          return fail(400, "Invalid chunk terminator");
+        }
+        rawPos += 2;
+        phase = Phase::ChunkSize;
+        break;
+
+      case Phase::Trailer: {
+        // Trailer header는 무시, 빈 줄에서 종료
+        size_t eol = buffer.find("\r\n", rawPos);
+        if (eol == std::string::npos) {
+          if (buffer.size() - rawPos > MAX_LINE_SIZE) {
+            return fail(400, "Trailer too long");
+          }
+          return Result::Incomplete;
+        }
+        bool last = eol == rawPos;
+        rawPos = eol + 2;
+        if (last) {
+          phase = Phase::Done;
+          return Result::Complete;
+        }
+        break;
+      }
+
+      default:
+        return Result::Incomplete;
+    }
+  }
+}
+
+HttpRequest HttpParser::request(const std::string& buffer) const {
+  auto view = [&buffer](const Span& span) {
+    return std::string_view(buffer.data() + span.pos, span.len);
+  };
+
+  HttpRequest req;
+  req.method = view(method);
+  req.version = view(version);
+
+  std::string_view full = view(target);
+  size_t q = full.find('?');
+  req.path = full.substr(0, q);
+  if (q != std::string_view::npos) {
+    req.query = full.substr(q + 1);
+  }
+
+  req.headers.reserve(headers.size());
+  for (const auto& h : headers) {
+    req.headers.emplace_back(view(h.first), view(h.second));
+  }
+
+  if (phase == Phase::Done && !streaming) {
+    req.body =
+        std::string_view(buffer.data() + bodyStart, bodyEnd - bodyStart);
+  }
+
+  req.streaming = streaming;
+  req.keepAlive = keepAlive;
+  req.chunked = chunked;
+  req.contentLength = contentLength;
+  return req;
+}
+
+}  // namespace server
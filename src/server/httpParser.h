@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace server {
+
+// Parse된 request (connection buffer를 가리키는 view)
+// buffer가 변경되기 전까지만 유효
+struct HttpRequest {
+  std::string_view method;
+  std::string_view path;
+  std::string_view query;
+  std::string_view version;
+  std::vector<std::pair<std::string_view, std::string_view>> headers;
+  std::string_view body;  // streaming request는 비어 있음
+
+  bool streaming = false;  // body는 handler가 socket에서 직접 읽음
+  bool keepAlive = false;
+  bool chunked = false;
+  uint64_t contentLength = 0;
+
+  // Header 이름은 대소문자 무시
+  std::string_view header(std::string_view name) const;
+};
+
+// Connection buffer 위에서 동작하는 incremental HTTP/1.1 parser
+// 새 data가 도착할 때마다 parse()를 다시 호출하면 이전 위치부터 이어서 처리
+class HttpParser {
+ public:
+  enum class Result {
+    Incomplete,       // data 더 필요
+    Complete,         // header + body 완료
+    HeadersComplete,  // streaming request: body는 handler가 직접 읽음
+    Error
+  };
+
+  // Chunked body는 buffer 안에서 제자리 decode (chunk header 제거)
+  Result parse(std::string& buffer);
+
+  // Complete/HeadersComplete 이후 호출
+  HttpRequest request(const std::string& buffer) const;
+
+  // 이 request가 차지한 byte 수 (HeadersComplete는 header 끝까지)
+  size_t consumed() const { return rawPos; }
+
+  int errorStatus() const { return status; }
+  const char* errorMessage() const { return error; }
+
+  void reset() { *this = HttpParser(); }
+
+ private:
+  struct Span {
+    size_t pos = 0;
+    size_t len = 0;
+  };
+
+  enum class Phase {
+    Headers,
+    Length,
+    ChunkSize,
+    ChunkData,
+    ChunkEnd,
+    Trailer,
+    Done
+  };
+
+  Result parseHeaders(const std::string& buffer);
+  Result parseChunked(std::string& buffer);
+  Result fail(int code, const char* message);
+
+  Phase phase = Phase::Headers;
+  size_t scanPos = 0;
+  size_t rawPos = 0;
+  size_t bodyStart = 0;
+  size_t bodyEnd = 0;
+  uint64_t chunkRemaining = 0;
+
+  Span method;
+  Span target;
+  Span version;
+  std::vector<std::pair<Span, Span>> headers;
+
+  bool keepAlive = false;
+  bool chunked = false;
+  bool streaming = false;
+  uint64_t contentLength = 0;
+
+  int status = 0;
+  const char* error = "";
+};
+
+}  // namespace server
@@ -0,0 +1,393 @@
+#include "httpServer.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <plog/Log.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <strings.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../utils/bodyReader.h"
+#include "../utils/config.h"
+#include "../utils/utils.h"
+
+namespace server {
+
+// Worker에서는 blocking I/O로 응답 (timeout 적용)
+static void setBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags >= 0) {
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+  }
+
+  struct timeval timeout;
+  timeout.tv_sec = Config::HTTP_TIMEOUT_SEC;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+// Keep-alive connection을 reactor로 되돌릴 때 호출
+static void setNonBlocking(int fd) {
+  int flags = fcntl(fd, F_GETFL, 0);
+  if (flags >= 0) {
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  }
+}
+
+HttpServer::HttpServer(int port, controllers::HttpController& controller)
+    : controller(controller), workers(Config::WORKER_THREADS) {
+  auto fail = [this](const char* msg) {
+    if (listenFd >= 0) close(listenFd);
+    if (epollFd >= 0) close(epollFd);
+    if (wakeFd >= 0) close(wakeFd);
+    listenFd = epollFd = wakeFd = -1;
+    throw std::runtime_error(msg);
+  };
+
+  // Socket 생성 및 설정
+  listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listenFd < 0) {
+    fail("Socket failed");
+  }
+
+  int opt = 1;
+  setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = INADDR_ANY;
+  addr.sin_port = htons(port);
+
+  if (bind(listenFd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+    fail("Bind failed");
+  }
+
+  if (listen(listenFd, Config::LISTEN_BACKLOG) < 0) {
+    fail("Listen failed");
+  }
+
+  // epoll 및 종료 알림용 eventfd
+  epollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (epollFd < 0) {
+    fail("Epoll create failed");
+  }
+
+  wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeFd < 0) {
+    fail("Eventfd create failed");
+  }
+
+  for (int fd : {listenFd, wakeFd}) {
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = static_cast<uint64_t>(fd);
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      fail("Epoll register failed");
+    }
+  }
+}
+
+HttpServer::~HttpServer() {
+  // 진행 중인 request가 epollFd에 connection을 다시 등록할 수 있으므로
+  // worker를 먼저 종료한 뒤 fd 정리
+  workers.join();
+  for (auto& entry : connections) {
+    close(entry.first);
+  }
+  connections.clear();
+
+  if (listenFd >= 0) close(listenFd);
+  if (epollFd >= 0) close(epollFd);
+  if (wakeFd >= 0) close(wakeFd);
+}
+
+void HttpServer::stop() {
+  uint64_t one = 1;
+  ssize_t r = write(wakeFd, &one, sizeof(one));
+  (void)r;
+}
+
+void HttpServer::run() {
+  std::vector<epoll_event> events(Config::EPOLL_MAX_EVENTS);
+  bool running = true;
+
+  while (running) {
+    // Idle connection 정리를 위해 주기적으로 깨어남
+    int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()),
+                       1000);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("Epoll wait failed");
+    }
+
+    for (int i = 0; i < n; ++i) {
+      int fd = static_cast<int>(events[i].data.u64);
+
+      if (fd == wakeFd) {
+        running = false;
+      } else if (fd == listenFd) {
+        acceptConnections();
+      } else {
+        handleReadable(fd);
+      }
+    }
+
+    sweepIdle();
+  }
+
+  // 신규 연결 차단 후 대기 중인 connection 정리
+  close(listenFd);
+  listenFd = -1;
+
+  std::lock_guard<std::mutex> lock(connMutex);
+  for (auto it = connections.begin(); it != connections.end();) {
+    if (it->second->busy) {
+      ++it;
+      continue;
+    }
+    close(it->first);
+    it = connections.erase(it);
+  }
+}
+
+bool HttpServer::arm(int fd, bool add) {
+  // ONESHOT: 한 번에 하나의 thread만 connection을 다룸
+  epoll_event ev = {};
+  ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+  ev.data.u64 = static_cast<uint64_t>(fd);
+  return epoll_ctl(epollFd, add ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void HttpServer::acceptConnections() {
+  while (true) {
+    sockaddr_in client_addr;
+    socklen_t len = sizeof(client_addr);
+    int client = accept4(listenFd, (sockaddr*)&client_addr, &len,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        PLOGW << "Accept failed: errno " << errno;
+      }
+      return;
+    }
+
+    // Client IP 추출
+    char ip_str[INET_ADDRSTRLEN];
+    std::string client_ip = "unknown";
+    if (inet_ntop(AF_INET, &client_addr.sin_addr, ip_str, sizeof(ip_str))) {
+      client_ip = ip_str;
+    }
+
+    auto conn = std::make_unique<Connection>();
+    conn->fd = client;
+    conn->ip = client_ip;
+    conn->lastActive = std::chrono::steady_clock::now();
+
+    {
+      std::lock_guard<std::mutex> lock(connMutex);
+      if (connections.size() >= Config::MAX_CONNECTIONS) {
+        PLOGW << client_ip << " - Connection limit reached";
+        close(client);
+        continue;
+      }
+      connections[client] = std::move(conn);
+    }
+
+    if (!arm(client, true)) {
+      closeConnection(client);
+    }
+  }
+}
+
+void HttpServer::handleReadable(int fd) {
+  Connection* conn;
+  {
+    std::lock_guard<std::mutex> lock(connMutex);
+    auto it = connections.find(fd);
+    if (it == connections.end()) {
+      return;
+    }
+    conn = it->second.get();
+  }
+
+  // Chunk overhead를 고려해 body 제한보다 header 크기만큼 여유를 둠
+  const size_t limit = Config::MAX_REQUEST_SIZE + Config::MAX_HEADER_SIZE;
+
+  char buf[Config::REQUEST_BUFFER_SIZE];
+  while (conn->buffer.size() <= limit) {
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n > 0) {
+      conn->buffer.append(buf, n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+
+    // EOF 또는 socket error
+    closeConnection(fd);
+    return;
+  }
+
+  conn->lastActive = std::chrono::steady_clock::now();
+
+  HttpParser::Result result = conn->parser.parse(conn->buffer);
+  if (result == HttpParser::Result::Complete ||
+      result == HttpParser::Result::HeadersComplete) {
+    dispatch(conn);
+    return;
+  }
+
+  if (result == HttpParser::Result::Error) {
+    PLOGW << conn->ip << " - " << conn->parser.errorMessage();
+    utils::sendHttpResponse(
+        fd, conn->parser.errorStatus(),
+        utils::jsonMsg(false, conn->parser.errorMessage()));
+    closeConnection(fd);
+    return;
+  }
+
+  if (conn->buffer.size() > limit) {
+    PLOGW << conn->ip << " - Request too large";
+    utils::sendHttpResponse(fd, 413,
+                            utils::jsonMsg(false, "Request too large"));
+    closeConnection(fd);
+    return;
+  }
+
+  if (!arm(fd, false)) {
+    closeConnection(fd);
+  }
+}
+
+void HttpServer::dispatch(Connection* conn) {
+  {
+    std::lock_guard<std::mutex> lock(connMutex);
+    conn->busy = true;
+  }
+  setBlocking(conn->fd);
+
+  workers.post([this, conn]() { serve(conn); });
+}
+
+void HttpServer::serve(Connection* conn) {
+  int fd = conn->fd;
+
+  // Buffer에 이미 완성된 다음 request가 있으면 이어서 처리 (pipelining)
+  while (true) {
+    if (!serveOne(conn)) {
+      closeConnection(fd);
+      return;
+    }
+
+    conn->parser.reset();
+    if (conn->buffer.empty()) {
+      break;
+    }
+
+    HttpParser::Result result = conn->parser.parse(conn->buffer);
+    if (result == HttpParser::Result::Error) {
+      utils::sendHttpResponse(
+          fd, conn->parser.errorStatus(),
+          utils::jsonMsg(false, conn->parser.errorMessage()));
+      closeConnection(fd);
+      return;
+    }
+    if (result == HttpParser::Result::Incomplete) {
+      break;
+    }
+  }
+
+  // 다음 request는 reactor가 non-blocking으로 수신
+  setNonBlocking(fd);
+  {
+    std::lock_guard<std::mutex> lock(connMutex);
+    conn->lastActive = std::chrono::steady_clock::now();
+    conn->busy = false;
+  }
+  if (!arm(fd, false)) {
+    closeConnection(fd);
+  }
+}
+
+// Request 하나를 처리하고 connection 유지 여부를 반환
+// Buffer에는 처리하지 않은 다음 request의 byte만 남김
+bool HttpServer::serveOne(Connection* conn) {
+  int fd = conn->fd;
+  bool keep_alive = false;
+
+  try {
+    HttpRequest request = conn->parser.request(conn->buffer);
+    keep_alive = request.keepAlive;
+    std::string rest;
+
+    if (request.streaming) {
+      // curl 등은 body 전송 전에 100 Continue를 기다림
+      std::string_view expect = request.header("Expect");
+      if (expect.size() == 12 &&
+          strncasecmp(expect.data(), "100-continue", 12) == 0) {
+        static const char CONTINUE_RESPONSE[] = "HTTP/1.1 100 Continue\r\n\r\n";
+        utils::sendAll(fd, CONTINUE_RESPONSE, sizeof(CONTINUE_RESPONSE) - 1);
+      }
+
+      utils::BodyReader body(fd, conn->buffer.substr(conn->parser.consumed()),
+                             request.chunked, request.contentLength);
+      controller.handleRequest(fd, conn->ip, request, &body);
+
+      // Body를 끝까지 읽지 못했으면 다음 request 위치를 알 수 없음
+      keep_alive = keep_alive && body.done();
+      rest = body.leftover();
+    } else {
+      controller.handleRequest(fd, conn->ip, request, nullptr);
+      rest = conn->buffer.substr(conn->parser.consumed());
+    }
+
+    conn->buffer = std::move(rest);
+  } catch (const std::exception& e) {
+    PLOGE << "Error: " << e.what();
+    return false;
+  }
+
+  return keep_alive;
+}
+
+void HttpServer::closeConnection(int fd) {
+  // fd 재사용 전에 map에서 제거되도록 lock 안에서 close
+  std::lock_guard<std::mutex> lock(connMutex);
+  if (connections.erase(fd) > 0) {
+    close(fd);
+  }
+}
+
+void HttpServer::sweepIdle() {
+  auto now = std::chrono::steady_clock::now();
+  auto timeout = std::chrono::seconds(Config::HTTP_TIMEOUT_SEC);
+
+  std::lock_guard<std::mutex> lock(connMutex);
+  for (auto it = connections.begin(); it != connections.end();) {
+    Connection* conn = it->second.get();
+    if (!conn->busy && now - conn->lastActive > timeout) {
+      PLOGI << conn->ip << " - Idle connection timeout";
+      close(it->first);
+      it = connections.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace server
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../controllers/httpController.h"
+#include "../utils/threadPool.h"
+#include "httpParser.h"
+
+namespace server {
+
+// epoll reactor: socket I/O는 reactor thread가 non-blocking으로 처리하고
+// 완성된 request만 worker pool로 전달
+// Keep-alive connection은 응답 후 다시 reactor에 등록 (pipelining 지원)
+class HttpServer {
+ public:
+  HttpServer(int port, controllers::HttpController& controller);
+  ~HttpServer();
+
+  HttpServer(const HttpServer&) = delete;
+  HttpServer& operator=(const HttpServer&) = delete;
+
+  void run();
+
+  // Signal handler에서 호출 가능 (eventfd write만 수행)
+  void stop();
+
+ private:
+  struct Connection {
+    int fd;
+    std::string ip;
+    std::string buffer;
+    HttpParser parser;
+    std::chrono::steady_clock::time_point lastActive;
+    bool busy = false;
+  };
+
+  void acceptConnections();
+  void handleReadable(int fd);
+  void dispatch(Connection* conn);
+  void serve(Connection* conn);
+  bool serveOne(Connection* conn);
+  void closeConnection(int fd);
+  void sweepIdle();
+  bool arm(int fd, bool add);
+
+  int listenFd = -1;
+  int epollFd = -1;
+  int wakeFd = -1;
+
+  controllers::HttpController& controller;
+
+  std::mutex connMutex;
+  std::unordered_map<int, std::unique_ptr<Connection>> connections;
+
+  // 소멸 시 진행 중인 request가 connection을 정리할 수 있도록 마지막에 선언
+  utils::ThreadPool workers;
+};
+
+}  // namespace server
@@ -0,0 +1,299 @@
+#include "changeTracker.h"
+
+#include <plog/Log.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../utils/config.h"
+#include "../utils/dirScanner.h"
+
+namespace services {
+
+namespace {
+
+constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY |
+                                IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO |
+                                IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR |
+                                IN_DONT_FOLLOW;
+
+struct Tracker {
+  std::string root;
+  bool valid = false;
+  uint64_t generation = 0;
+  std::chrono::system_clock::time_point lastModified;
+  std::set<std::string> dirty;
+  bool dirtyOverflow = false;
+  std::unordered_set<int> wds;
+  // watch 등록 실패 후 이 시각까지는 다시 시도하지 않음
+  // (watch 한도 초과 시 compress마다 전체 tree를 다시 등록하지 않도록)
+  std::chrono::steady_clock::time_point retryAfter;
+};
+
+struct Watch {
+  std::string user;
+  std::string path;  // workspace 기준 상대 경로 (root: "")
+};
+
+class Watcher {
+ public:
+  Watcher() {
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0) {
+      PLOGW << "Change tracking disabled: inotify unavailable";
+      return;
+    }
+    thread = std::thread(&Watcher::loop, this);
+  }
+
+  ~Watcher() {
+    if (thread.joinable()) {
+      uint64_t one = 1;
+      ssize_t r = write(wakeFd, &one, sizeof(one));
+      (void)r;
+      thread.join();
+    }
+    if (inotifyFd >= 0) close(inotifyFd);
+    if (wakeFd >= 0) close(wakeFd);
+  }
+
+  bool enabled() const { return thread.joinable(); }
+
+  std::mutex mutex;
+  std::unordered_map<std::string, Tracker> trackers;
+
+  // Directory tree 전체에 watch 등록 (lock 보유 상태에서 호출)
+  bool addTree(const std::string& user, Tracker& t, const std::string& rel) {
+    if (!addWatch(user, t, rel)) {
+      return false;
+    }
+
+    std::string dir = rel.empty() ? t.root : t.root + "/" + rel;
+    bool ok = true;
+    try {
+      utils::scanTree(dir, Config::SCAN_THREADS,
+                      [&](const utils::ScanEntry& entry) {
+                        if (ok && S_ISDIR(entry.st.st_mode)) {
+                          std::string path = rel.empty()
+                                                 ? entry.path
+                                                 : rel + "/" + entry.path;
+                          ok = addWatch(user, t, path);
+                        }
+                      });
+    } catch (const std::exception& e) {
+      // 등록 도중 삭제된 directory는 이벤트로 반영됨
+      PLOGD << "Watch scan failed for " << dir << ": " << e.what();
+    }
+    return ok;
+  }
+
+  // 모든 watch 해제 후 추적 중지 (lock 보유 상태에서 호출)
+  void invalidate(Tracker& t) {
+    for (int wd : t.wds) {
+      inotify_rm_watch(inotifyFd, wd);
+      watches.erase(wd);
+    }
+    t.wds.clear();
+    t.valid = false;
+    t.dirty.clear();
+    t.dirtyOverflow = false;
+    ++t.generation;
+  }
+
+  // Watch 등록 실패: 추적 해제 후 WATCH_RETRY_SEC 동안 재등록하지 않음
+  void fail(Tracker& t) {
+    invalidate(t);
+    t.retryAfter = std::chrono::steady_clock::now() +
+                   std::chrono::seconds(Config::WATCH_RETRY_SEC);
+  }
+
+ private:
+  bool addWatch(const std::string& user, Tracker& t, const std::string& rel) {
+    std::string path = rel.empty() ? t.root : t.root + "/" + rel;
+    int wd = inotify_add_watch(inotifyFd, path.c_str(), WATCH_MASK);
+    if (wd < 0) {
+      // 하위 directory의 ENOENT: 등록 전에 삭제됨 (무시)
+      if (!rel.empty() && (errno == ENOENT || errno == ENOTDIR)) {
+        return true;
+      }
+      PLOGW << "inotify_add_watch failed for " << path << ": errno "
+            << errno;
+      return false;
+    }
+    watches[wd] = Watch{user, rel};
+    t.wds.insert(wd);
+    return true;
+  }
+
+  void markDirty(Tracker& t, const std::string& rel) {
+    ++t.generation;
+    t.lastModified = std::chrono::system_clock::now();
+    if (t.dirtyOverflow) {
+      return;
+    }
+    t.dirty.insert(rel);
+    if (t.dirty.size() > Config::MAX_DIRTY_PATHS) {
+      t.dirty.clear();
+      t.dirtyOverflow = true;
+    }
+  }
+
+  void handle(const inotify_event* ev) {
+    // Event 유실: 모든 추적 해제 (다음 watch()에서 재등록)
+    if (ev->mask & IN_Q_OVERFLOW) {
+      PLOGW << "inotify queue overflow, resetting change tracking";
+      for (auto& entry : trackers) {
+        invalidate(entry.second);
+      }
+      return;
+    }
+
+    auto it = watches.find(ev->wd);
+    if (it == watches.end()) {
+      return;
+    }
+    Watch watch = it->second;
+    Tracker& t = trackers[watch.user];
+
+    if (ev->mask & IN_IGNORED) {
+      t.wds.erase(ev->wd);
+      watches.erase(it);
+      return;
+    }
+
+    std::string rel = watch.path;
+    if (ev->len > 0) {
+      rel = rel.empty() ? ev->name : rel + "/" + ev->name;
+    }
+    markDirty(t, rel);
+
+    // Workspace root가 이동/삭제됨 (extract 교체 등)
+    if ((ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) && watch.path.empty()) {
+      invalidate(t);
+      return;
+    }
+
+    // 새 directory: 하위 tree까지 watch 추가
+    if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) && (ev->mask & IN_ISDIR)) {
+      if (!addTree(watch.user, t, rel)) {
+        fail(t);
+      }
+    }
+  }
+
+  void loop() {
+    alignas(inotify_event) char buf[65536];
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeFd, POLLIN, 0}};
+
+    while (true) {
+      if (poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) continue;
+        PLOGE << "Change tracker poll failed: errno " << errno;
+        return;
+      }
+      if (fds[1].revents) {
+        return;
+      }
+
+      ssize_t n = read(inotifyFd, buf, sizeof(buf));
+      if (n <= 0) {
+        continue;
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      for (char* p = buf; p < buf + n;) {
+        auto* ev = reinterpret_cast<inotify_event*>(p);
+        handle(ev);
+        p += sizeof(inotify_event) + ev->len;
+      }
+    }
+  }
+
+  int inotifyFd = -1;
+  int wakeFd = -1;
+  std::unordered_map<int, Watch> watches;
+  std::thread thread;
+};
+
+Watcher& watcher() {
+  static Watcher instance;
+  return instance;
+}
+
+}  // namespace
+
+bool ChangeTracker::watch(const std::string& user) {
+  Watcher& w = watcher();
+  if (!w.enabled()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(w.mutex);
+  Tracker& t = w.trackers[user];
+  if (t.valid) {
+    return true;
+  }
+  if (std::chrono::steady_clock::now() < t.retryAfter) {
+    return false;
+  }
+
+  t.root = Config::PATH_HOME_BASE + user + Config::PATH_WORKSPACE;
+  if (!w.addTree(user, t, "")) {
+    w.fail(t);
+    return false;
+  }
+
+  // 등록 이전 상태는 알 수 없으므로 새 generation에서 시작
+  t.valid = true;
+  ++t.generation;
+  t.lastModified = std::chrono::system_clock::now();
+  return true;
+}
+
+bool ChangeTracker::changes(const std::string& user,
+                            WorkspaceChanges& changes) {
+  Watcher& w = watcher();
+  std::lock_guard<std::mutex> lock(w.mutex);
+  auto it = w.trackers.find(user);
+  if (it == w.trackers.end() || !it->second.valid) {
+    return false;
+  }
+
+  const Tracker& t = it->second;
+  changes.generation = t.generation;
+  changes.lastModified = t.lastModified;
+  changes.dirty.assign(t.dirty.begin(), t.dirty.end());
+  changes.dirtyOverflow = t.dirtyOverflow;
+  return true;
+}
+
+void ChangeTracker::clearDirty(const std::string& user, uint64_t generation) {
+  Watcher& w = watcher();
+  std::lock_guard<std::mutex> lock(w.mutex);
+  auto it = w.trackers.find(user);
+  if (it != w.trackers.end() && it->second.generation == generation) {
+    it->second.dirty.clear();
+    it->second.dirtyOverflow = false;
+  }
+}
+
+void ChangeTracker::reset(const std::string& user) {
+  Watcher& w = watcher();
+  std::lock_guard<std::mutex> lock(w.mutex);
+  auto it = w.trackers.find(user);
+  if (it != w.trackers.end()) {
+    w.invalidate(it->second);
+    it->second.retryAfter = {};
+  }
+}
+
+}  // namespace services
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace services {
+
+struct WorkspaceChanges {
+  uint64_t generation;  // 변경이 감지될 때마다 증가
+  std::chrono::system_clock::time_point lastModified;
+  std::vector<std::string> dirty;  // workspace 기준 상대 경로
+  bool dirtyOverflow;              // dirty 목록이 한도를 넘어 전체가 변경됨
+};
+
+// inotify 기반 workspace 변경 추적 (background thread 하나)
+// 추적 중인 동안에는 tree를 walk하지 않고 변경 여부를 판단할 수 있음
+// 이벤트 유실(queue overflow, watch 한도 초과) 시 추적이 해제되며
+// 다음 watch()에서 다시 등록 (watch 등록 실패 후에는 WATCH_RETRY_SEC 동안
+// 다시 시도하지 않고 false)
+class ChangeTracker {
+ public:
+  // 추적 시작 (이미 추적 중이면 바로 반환, 실패 시 false)
+  static bool watch(const std::string& user);
+
+  // 추적 중이 아니면 false
+  static bool changes(const std::string& user, WorkspaceChanges& changes);
+
+  // generation이 그대로면 dirty 목록 비움 (snapshot 완료 후 호출)
+  static void clearDirty(const std::string& user, uint64_t generation);
+
+  // Workspace directory가 교체된 경우 추적 해제 (재등록 대기도 해제)
+  static void reset(const std::string& user);
+};
+
+}  // namespace services
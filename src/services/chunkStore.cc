@@ -0,0 +1,609 @@
+#include "chunkStore.h"
+
+#include <fcntl.h>
+#include <plog/Log.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../codecs/parallelGzip.h"
+#include "../utils/chunker.h"
+#include "../utils/config.h"
+#include "../utils/filePrefetcher.h"
+#include "../utils/sha256.h"
+#include "../utils/threadPool.h"
+
+namespace fs = std::filesystem;
+
+namespace services {
+
+namespace {
+
+struct ChunkRef {
+  std::string hash;  // SHA-256 hex
+  uint32_t size;     // 압축 전 크기
+};
+
+struct RecipeEntry {
+  std::string path;
+  uint32_t mode = 0;
+  uint64_t size = 0;
+  int64_t mtime_ns = 0;
+  uint64_t ino = 0;
+  std::string target;  // symlink 대상
+  std::vector<ChunkRef> chunks;
+};
+
+std::string chunkPath(const std::string& hash) {
+  return std::string(Config::PATH_CHUNK_STORE) + "/chunks/" +
+         hash.substr(0, 2) + "/" + hash;
+}
+
+std::string recipeDir(const std::string& user) {
+  return std::string(Config::PATH_CHUNK_STORE) + "/snapshots/" + user;
+}
+
+// Recipe 형식: entry마다 "<mode> <size> <mtime_ns> <ino> <chunk 수> <path>\0"
+// (symlink는 이어서 "<target>\0") 다음에 chunk마다 "<hash> <size>\n"
+std::string serializeRecipe(const std::vector<RecipeEntry>& entries) {
+  std::ostringstream out;
+  for (const RecipeEntry& e : entries) {
+    out << e.mode << ' ' << e.size << ' ' << e.mtime_ns << ' ' << e.ino << ' '
+        << e.chunks.size() << ' ' << e.path << '\0';
+    if (S_ISLNK(e.mode)) {
+      out << e.target << '\0';
+    }
+    for (const ChunkRef& chunk : e.chunks) {
+      out << chunk.hash << ' ' << chunk.size << '\n';
+    }
+  }
+  return out.str();
+}
+
+// Recipe 목록 (저장 중인 임시 파일 제외)
+std::vector<std::pair<fs::file_time_type, fs::path>> listRecipes(
+    const fs::path& dir) {
+  std::vector<std::pair<fs::file_time_type, fs::path>> recipes;
+  std::error_code ec;
+  for (const auto& recipe : fs::directory_iterator(dir, ec)) {
+    auto time = recipe.last_write_time(ec);
+    if (!ec && recipe.path().extension() != ".tmp") {
+      recipes.emplace_back(time, recipe.path());
+    }
+  }
+  std::sort(recipes.begin(), recipes.end());
+  return recipes;
+}
+
+bool loadRecipe(const std::string& path, std::vector<RecipeEntry>& entries) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  entries.clear();
+  RecipeEntry e;
+  size_t count;
+  while (file >> e.mode >> e.size >> e.mtime_ns >> e.ino >> count) {
+    if (file.get() != ' ' || !std::getline(file, e.path, '\0')) {
+      return false;
+    }
+    e.target.clear();
+    if (S_ISLNK(e.mode) && !std::getline(file, e.target, '\0')) {
+      return false;
+    }
+    e.chunks.resize(count);
+    for (ChunkRef& chunk : e.chunks) {
+      if (!(file >> chunk.hash >> chunk.size) || chunk.hash.size() != 64) {
+        return false;
+      }
+    }
+    entries.push_back(e);
+  }
+  return file.eof();
+}
+
+// Recipe의 mtime (ns) -> timespec (기록되지 않은 0은 변경하지 않음)
+timespec toTimespec(int64_t ns) {
+  if (ns == 0) {
+    return {0, UTIME_OMIT};
+  }
+  int64_t sec = ns / 1000000000;
+  int64_t nsec = ns % 1000000000;
+  if (nsec < 0) {
+    --sec;
+    nsec += 1000000000;
+  }
+  return {static_cast<time_t>(sec), static_cast<long>(nsec)};
+}
+
+// 같은 내용은 같은 경로이므로 임시 파일에 쓴 뒤 rename (동시 저장 허용)
+void writeChunk(const std::string& path, const std::string& data) {
+  uLongf len = compressBound(static_cast<uLong>(data.size()));
+  std::string compressed(len, '\0');
+  if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &len,
+                reinterpret_cast<const Bytef*>(data.data()),
+                static_cast<uLong>(data.size()),
+                Config::CHUNK_LEVEL) != Z_OK) {
+    throw std::runtime_error("Failed to compress chunk");
+  }
+
+  fs::create_directories(fs::path(path).parent_path());
+  std::ostringstream tmp_name;
+  tmp_name << path << ".tmp." << std::this_thread::get_id();
+  std::string tmp = tmp_name.str();
+  {
+    std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+    file.write(compressed.data(), static_cast<std::streamsize>(len));
+    file.flush();
+    if (!file) {
+      file.close();
+      fs::remove(tmp);
+      throw std::runtime_error("Failed to write chunk");
+    }
+  }
+  fs::rename(tmp, path);
+}
+
+// Chunk 읽기 + 압축 해제 + hash 검증
+std::string readChunk(const ChunkRef& ref) {
+  std::ifstream file(chunkPath(ref.hash), std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Missing chunk " + ref.hash);
+  }
+  std::string compressed((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+  std::string data(ref.size, '\0');
+  uLongf len = ref.size;
+  if (uncompress(reinterpret_cast<Bytef*>(&data[0]), &len,
+                 reinterpret_cast<const Bytef*>(compressed.data()),
+                 static_cast<uLong>(compressed.size())) != Z_OK ||
+      len != ref.size ||
+      utils::Sha256::hash(data.data(), data.size()) != ref.hash) {
+    throw std::runtime_error("Corrupted chunk " + ref.hash);
+  }
+  return data;
+}
+
+// Chunk refcount (모든 user 공유)
+class Store {
+ public:
+  void acquire(const std::string& hash) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ensureLoaded();
+    ++refs[hash];
+  }
+
+  // 0이 된 chunk는 삭제
+  void release(const std::vector<std::string>& hashes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ensureLoaded();
+    for (const std::string& hash : hashes) {
+      auto it = refs.find(hash);
+      if (it == refs.end() || --it->second > 0) {
+        continue;
+      }
+      refs.erase(it);
+      std::error_code ec;
+      fs::remove(chunkPath(hash), ec);
+    }
+  }
+
+  void load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ensureLoaded();
+  }
+
+ private:
+  // 모든 recipe에서 refcount 계산 후 참조되지 않는 chunk 삭제 (GC)
+  void ensureLoaded() {
+    if (loaded) {
+      return;
+    }
+    loaded = true;
+
+    std::error_code ec;
+    std::vector<RecipeEntry> entries;
+    fs::path snapshots = std::string(Config::PATH_CHUNK_STORE) + "/snapshots";
+    for (const auto& user : fs::directory_iterator(snapshots, ec)) {
+      for (const auto& recipe : listRecipes(user.path())) {
+        if (!loadRecipe(recipe.second.string(), entries)) {
+          PLOGW << "Invalid recipe " << recipe.second.string();
+          continue;
+        }
+        for (const RecipeEntry& e : entries) {
+          for (const ChunkRef& chunk : e.chunks) {
+            ++refs[chunk.hash];
+          }
+        }
+      }
+    }
+
+    size_t removed = 0;
+    fs::path chunks = std::string(Config::PATH_CHUNK_STORE) + "/chunks";
+    for (const auto& dir : fs::directory_iterator(chunks, ec)) {
+      for (const auto& chunk : fs::directory_iterator(dir.path(), ec)) {
+        if (refs.count(chunk.path().filename().string()) == 0) {
+          fs::remove(chunk.path(), ec);
+          ++removed;
+        }
+      }
+    }
+    PLOGI << "Chunk store loaded: " << refs.size() << " chunks, " << removed
+          << " unreferenced removed";
+  }
+
+  std::mutex mutex;
+  bool loaded = false;
+  std::unordered_map<std::string, uint32_t> refs;
+};
+
+Store& store() {
+  static Store instance;
+  return instance;
+}
+
+// 가장 최근 recipe (없으면 false)
+bool loadLatest(const std::string& user, std::vector<RecipeEntry>& entries) {
+  auto recipes = listRecipes(recipeDir(user));
+  return !recipes.empty() &&
+         loadRecipe(recipes.back().second.string(), entries);
+}
+
+// MAX_STORED_SNAPSHOTS를 넘는 오래된 recipe 삭제
+void prune(const std::string& user) {
+  auto recipes = listRecipes(recipeDir(user));
+  if (recipes.size() <= Config::MAX_STORED_SNAPSHOTS) {
+    return;
+  }
+
+  std::error_code ec;
+  std::vector<RecipeEntry> entries;
+  for (size_t i = 0; i + Config::MAX_STORED_SNAPSHOTS < recipes.size(); ++i) {
+    std::vector<std::string> hashes;
+    if (loadRecipe(recipes[i].second.string(), entries)) {
+      for (const RecipeEntry& e : entries) {
+        for (const ChunkRef& chunk : e.chunks) {
+          hashes.push_back(chunk.hash);
+        }
+      }
+    }
+    fs::remove(recipes[i].second, ec);
+    store().release(hashes);
+  }
+}
+
+}  // namespace
+
+std::string ChunkStore::save(const std::string& user,
+                             std::atomic<uint64_t>* progress) {
+  std::string workspace =
+      Config::PATH_HOME_BASE + user + Config::PATH_WORKSPACE;
+  struct stat root_st;
+  if (stat(workspace.c_str(), &root_st) != 0 || !S_ISDIR(root_st.st_mode)) {
+    throw std::runtime_error("Workspace directory does not exist");
+  }
+
+  Store& s = store();
+  s.load();
+
+  // 이전 snapshot과 metadata가 같은 file은 chunk 목록 재사용
+  std::vector<RecipeEntry> previous;
+  loadLatest(user, previous);
+  std::unordered_map<std::string, const RecipeEntry*> previous_index;
+  for (const RecipeEntry& e : previous) {
+    previous_index[e.path] = &e;
+  }
+  auto unchanged = [&previous_index](const utils::ScanEntry& entry)
+      -> const RecipeEntry* {
+    auto it = previous_index.find(entry.path);
+    if (it == previous_index.end()) {
+      return nullptr;
+    }
+    const RecipeEntry& e = *it->second;
+    int64_t mtime_ns =
+        static_cast<int64_t>(entry.st.st_mtim.tv_sec) * 1000000000 +
+        entry.st.st_mtim.tv_nsec;
+    bool same = e.mode == static_cast<uint32_t>(entry.st.st_mode) &&
+                e.size == static_cast<uint64_t>(entry.st.st_size) &&
+                e.mtime_ns == mtime_ns &&
+                e.ino == static_cast<uint64_t>(entry.st.st_ino);
+    return same ? &e : nullptr;
+  };
+
+  // 첫 entry "."는 workspace 자체 (mode/mtime만 기록)
+  std::vector<RecipeEntry> entries(1);
+  entries[0].path = ".";
+  entries[0].mode = static_cast<uint32_t>(root_st.st_mode);
+  entries[0].mtime_ns =
+      static_cast<int64_t>(root_st.st_mtim.tv_sec) * 1000000000 +
+      root_st.st_mtim.tv_nsec;
+  std::vector<std::string> acquired;  // 실패 시 반환할 참조
+
+  // 새 chunk의 hash/압축/저장은 pool에서, recipe에는 순서대로 기록
+  size_t threads =
+      codecs::ParallelGzipWriter::resolveThreads(Config::COMPRESS_THREADS);
+  utils::ThreadPool pool(threads);
+  std::deque<std::pair<size_t, std::future<ChunkRef>>> pending;
+
+  auto emitFront = [&]() {
+    auto item = std::move(pending.front());
+    pending.pop_front();
+    ChunkRef ref = item.second.get();
+    acquired.push_back(ref.hash);
+    entries[item.first].chunks.push_back(std::move(ref));
+  };
+
+  size_t current = 0;
+  utils::Chunker chunker([&](std::string chunk) {
+    pending.emplace_back(
+        current, pool.submit([&s, chunk = std::move(chunk)]() {
+          ChunkRef ref{utils::Sha256::hash(chunk.data(), chunk.size()),
+                       static_cast<uint32_t>(chunk.size())};
+          s.acquire(ref.hash);
+          try {
+            std::string path = chunkPath(ref.hash);
+            if (access(path.c_str(), F_OK) != 0) {
+              writeChunk(path, chunk);
+            }
+          } catch (...) {
+            s.release({ref.hash});
+            throw;
+          }
+          return ref;
+        }));
+    while (pending.size() > threads * 4) {
+      emitFront();
+    }
+  });
+
+  try {
+    utils::FilePrefetcher files(
+        workspace, utils::ReadOrder::Name,
+        [&unchanged](const utils::ScanEntry& entry) {
+          return unchanged(entry) == nullptr;
+        },
+        nullptr, true);
+    utils::ScanEntry scanned;
+
+    while (files.next(scanned)) {
+      RecipeEntry entry;
+      entry.path = scanned.path;
+      entry.mode = static_cast<uint32_t>(scanned.st.st_mode);
+      entry.size = static_cast<uint64_t>(scanned.st.st_size);
+      entry.mtime_ns =
+          static_cast<int64_t>(scanned.st.st_mtim.tv_sec) * 1000000000 +
+          scanned.st.st_mtim.tv_nsec;
+      entry.ino = static_cast<uint64_t>(scanned.st.st_ino);
+      current = entries.size();
+      entries.push_back(std::move(entry));
+
+      if (S_ISLNK(scanned.st.st_mode)) {
+        std::string path = workspace + "/" + scanned.path;
+        std::string& target = entries[current].target;
+        target.resize(static_cast<size_t>(scanned.st.st_size) + 1);
+        ssize_t n = readlink(path.c_str(), &target[0], target.size());
+        if (n < 0 || static_cast<size_t>(n) >= target.size()) {
+          throw std::runtime_error("Failed to read link " + scanned.path);
+        }
+        target.resize(static_cast<size_t>(n));
+        continue;
+      }
+      if (!S_ISREG(scanned.st.st_mode)) {
+        continue;
+      }
+
+      const RecipeEntry* prev = unchanged(scanned);
+      if (prev) {
+        for (const ChunkRef& chunk : prev->chunks) {
+          s.acquire(chunk.hash);
+          acquired.push_back(chunk.hash);
+        }
+        entries[current].chunks = prev->chunks;
+        if (progress) {
+          *progress += entries[current].size;
+        }
+        continue;
+      }
+
+      const char* data;
+      size_t len;
+      while (files.read(data, len)) {
+        chunker.write(data, len);
+        if (progress) {
+          *progress += len;
+        }
+      }
+      chunker.finish();
+    }
+
+    while (!pending.empty()) {
+      emitFront();
+    }
+  } catch (...) {
+    // 진행 중인 chunk 작업을 기다린 뒤 이번 저장에서 늘린 참조 반환
+    while (!pending.empty()) {
+      try {
+        emitFront();
+      } catch (...) {
+      }
+    }
+    s.release(acquired);
+    throw;
+  }
+
+  // 새 chunk 수는 이 user의 recipe 기준으로 계산
+  // (store 전체 기준이면 다른 user가 같은 chunk를 가졌는지 드러남)
+  std::unordered_set<std::string> known;
+  std::vector<RecipeEntry> stored;
+  for (const auto& recipe : listRecipes(recipeDir(user))) {
+    if (loadRecipe(recipe.second.string(), stored)) {
+      for (const RecipeEntry& e : stored) {
+        for (const ChunkRef& chunk : e.chunks) {
+          known.insert(chunk.hash);
+        }
+      }
+    }
+  }
+  size_t fresh = 0;
+  for (const RecipeEntry& e : entries) {
+    for (const ChunkRef& chunk : e.chunks) {
+      if (known.insert(chunk.hash).second) {
+        ++fresh;
+      }
+    }
+  }
+
+  // Snapshot id: recipe 내용의 hash (같은 상태면 같은 id)
+  std::string recipe = serializeRecipe(entries);
+  std::string id = utils::Sha256::hash(recipe.data(), recipe.size())
+                       .substr(0, 16);
+  std::string path = recipeDir(user) + "/" + id;
+
+  try {
+    if (fs::exists(path)) {
+      // 이미 같은 recipe가 참조를 가지고 있음 (최신으로 표시만 갱신)
+      s.release(acquired);
+      fs::last_write_time(path, fs::file_time_type::clock::now());
+    } else {
+      fs::create_directories(recipeDir(user));
+      std::string tmp = path + ".tmp";
+      {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        file.write(recipe.data(), static_cast<std::streamsize>(recipe.size()));
+        file.flush();
+        if (!file) {
+          throw std::runtime_error("Failed to write snapshot");
+        }
+      }
+      fs::rename(tmp, path);
+    }
+  } catch (...) {
+    s.release(acquired);
+    throw;
+  }
+
+  prune(user);
+  return id + " (" + std::to_string(fresh) + " new chunks)";
+}
+
+void ChunkStore::restore(const std::string& user, const std::string& id,
+                         const std::string& target,
+                         std::atomic<uint64_t>* progress) {
+  if (id.size() != 16 ||
+      id.find_first_not_of("0123456789abcdef") != std::string::npos) {
+    throw std::invalid_argument("Invalid snapshot id");
+  }
+
+  std::vector<RecipeEntry> entries;
+  if (!loadRecipe(recipeDir(user) + "/" + id, entries)) {
+    throw std::runtime_error("Snapshot not found");
+  }
+
+  if (mkdir(target.c_str(), 0700) != 0) {
+    throw std::runtime_error("Failed to create directory: " +
+                             std::string(strerror(errno)));
+  }
+
+  // 쓰기 권한이 없는 directory도 채울 수 있도록 mode는 마지막에 복원
+  // (mtime도 하위 entry를 모두 만든 뒤 적용)
+  // 소유자는 복원하지 않으므로 setuid/setgid 제외 (server 소유 file이 됨)
+  struct Dir {
+    std::string path;
+    mode_t mode;
+    timespec mtime;
+  };
+  std::vector<Dir> dirs;
+  for (const RecipeEntry& e : entries) {
+    mode_t mode = static_cast<mode_t>(e.mode) & 01777;
+    const timespec times[2] = {{0, UTIME_OMIT}, toTimespec(e.mtime_ns)};
+    if (e.path == ".") {
+      dirs.push_back({target, mode, times[1]});
+      continue;
+    }
+    std::string path = target + "/" + e.path;
+
+    if (S_ISDIR(e.mode)) {
+      if (mkdir(path.c_str(), 0700) != 0) {
+        throw std::runtime_error("Failed to create directory: " +
+                                 std::string(strerror(errno)));
+      }
+      dirs.push_back({path, mode, times[1]});
+      continue;
+    }
+
+    if (S_ISLNK(e.mode)) {
+      if (symlink(e.target.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to create link " + e.path + ": " +
+                                 strerror(errno));
+      }
+      utimensat(AT_FDCWD, path.c_str(), times, AT_SYMLINK_NOFOLLOW);
+      continue;
+    }
+
+    if (!S_ISREG(e.mode)) {
+      if (mknod(path.c_str(), (e.mode & S_IFMT) | mode, 0) == 0) {
+        utimensat(AT_FDCWD, path.c_str(), times, AT_SYMLINK_NOFOLLOW);
+      }
+      continue;
+    }
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+      throw std::runtime_error("Failed to create " + e.path + ": " +
+                               strerror(errno));
+    }
+    try {
+      for (const ChunkRef& chunk : e.chunks) {
+        std::string data = readChunk(chunk);
+        const char* p = data.data();
+        size_t left = data.size();
+        while (left > 0) {
+          ssize_t n = write(fd, p, left);
+          if (n < 0 && errno == EINTR) {
+            continue;
+          }
+          if (n < 0) {
+            throw std::runtime_error("Failed to write " + e.path + ": " +
+                                     strerror(errno));
+          }
+          p += n;
+          left -= static_cast<size_t>(n);
+        }
+        if (progress) {
+          *progress += data.size();
+        }
+      }
+    } catch (...) {
+      close(fd);
+      throw;
+    }
+    fchmod(fd, mode);
+    futimens(fd, times);
+    close(fd);
+  }
+
+  for (auto it = dirs.rbegin(); it != dirs.rend(); ++it) {
+    const timespec times[2] = {{0, UTIME_OMIT}, it->mtime};
+    chmod(it->path.c_str(), it->mode);
+    utimensat(AT_FDCWD, it->path.c_str(), times, 0);
+  }
+}
+
+}  // namespace services
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace services {
+
+// 모든 user가 공유하는 content-addressed chunk store
+// File 내용을 content-defined chunk로 나누어 SHA-256 주소로 한 번만 저장
+// (zlib 압축), snapshot은 entry 목록과 chunk 주소 목록(recipe)만 가짐
+//
+// Chunk는 recipe에서 참조되는 횟수로 reference counting하며 0이 되면 삭제
+// Refcount는 처음 사용할 때 recipe 전체에서 다시 계산하고, 이때 어느
+// recipe에서도 참조하지 않는 chunk(중단된 저장 등)도 함께 정리
+class ChunkStore {
+ public:
+  // Workspace를 store에 저장 (snapshot id 반환, 오래된 snapshot 정리)
+  // 이전 snapshot과 path/size/mtime/inode가 같은 file은 다시 읽지 않음
+  // 함께 반환하는 새 chunk 수는 이 user의 snapshot에 없던 chunk 수
+  // (다른 user의 chunk 보유 여부가 드러나지 않도록 store 전체와 비교 안 함)
+  static std::string save(const std::string& user,
+                          std::atomic<uint64_t>* progress = nullptr);
+
+  // Snapshot을 target directory(없어야 함)에 복원
+  static void restore(const std::string& user, const std::string& id,
+                      const std::string& target,
+                      std::atomic<uint64_t>* progress = nullptr);
+};
+
+}  // namespace services
@@ -0,0 +1,192 @@
+#include "jobService.h"
+
+#include <plog/Log.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../utils/config.h"
+#include "../utils/threadPool.h"
+
+namespace services {
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Job {
+  std::string id;
+  std::string type;
+  std::string user;
+  JobState state = JobState::Queued;
+  std::atomic<uint64_t> bytes{0};
+  Clock::time_point started;
+  Clock::time_point finished;
+  std::string message;
+};
+
+struct JobTable {
+  std::mutex mutex;
+  std::unordered_map<std::string, std::shared_ptr<Job>> jobs;
+  std::unordered_set<std::string> activeUsers;
+
+  // 소멸 시 실행 중인 job이 table에 접근하므로 마지막에 선언
+  utils::ThreadPool pool{Config::JOB_THREADS};
+};
+
+JobTable& table() {
+  static JobTable instance;
+  return instance;
+}
+
+std::string newJobId() {
+  static std::mt19937_64 rng(std::random_device{}());
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx",
+           static_cast<unsigned long long>(rng()));
+  return buf;
+}
+
+// 완료 후 보관 기간이 지난 job 제거 (lock 보유 상태에서 호출)
+void pruneLocked(JobTable& t) {
+  auto now = Clock::now();
+  auto retention = std::chrono::seconds(Config::JOB_RETENTION_SEC);
+
+  for (auto it = t.jobs.begin(); it != t.jobs.end();) {
+    const Job& job = *it->second;
+    bool done =
+        job.state == JobState::Succeeded || job.state == JobState::Failed;
+    if (done && now - job.finished > retention) {
+      it = t.jobs.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace
+
+std::string JobService::submit(const std::string& type,
+                               const std::string& user, Task task) {
+  JobTable& t = table();
+  auto job = std::make_shared<Job>();
+  job->type = type;
+  job->user = user;
+
+  {
+    std::lock_guard<std::mutex> lock(t.mutex);
+    pruneLocked(t);
+
+    // 같은 workspace에 대한 동시 작업 방지
+    if (t.activeUsers.count(user)) {
+      throw JobConflictError("Another job is in progress for this user");
+    }
+    if (t.jobs.size() >= Config::MAX_JOBS) {
+      throw std::runtime_error("Too many jobs");
+    }
+
+    do {
+      job->id = newJobId();
+    } while (t.jobs.count(job->id));
+
+    t.jobs[job->id] = job;
+    t.activeUsers.insert(user);
+  }
+
+  PLOGI << "Job " << job->id << " queued: " << type << " " << user;
+
+  t.pool.post([job, task = std::move(task)]() {
+    JobTable& t = table();
+    {
+      std::lock_guard<std::mutex> lock(t.mutex);
+      job->state = JobState::Running;
+      job->started = Clock::now();
+    }
+
+    JobState state;
+    std::string message;
+    try {
+      message = task(job->bytes);
+      state = JobState::Succeeded;
+    } catch (const std::exception& e) {
+      message = e.what();
+      state = JobState::Failed;
+    }
+
+    PLOGI << "Job " << job->id << " " << stateName(state) << ": " << message;
+
+    std::lock_guard<std::mutex> lock(t.mutex);
+    job->state = state;
+    job->message = message;
+    job->finished = Clock::now();
+    t.activeUsers.erase(job->user);
+  });
+
+  return job->id;
+}
+
+bool JobService::find(const std::string& id, JobStatus& status) {
+  JobTable& t = table();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  pruneLocked(t);
+
+  auto it = t.jobs.find(id);
+  if (it == t.jobs.end()) {
+    return false;
+  }
+
+  const Job& job = *it->second;
+  status.id = job.id;
+  status.type = job.type;
+  status.user = job.user;
+  status.state = job.state;
+  status.bytes = job.bytes.load();
+  status.message = job.message;
+
+  // Elapsed: 시작 시점부터 (완료된 job은 완료 시점까지)
+  status.elapsed_ms = 0;
+  if (job.state != JobState::Queued) {
+    auto end = job.state == JobState::Running ? Clock::now() : job.finished;
+    status.elapsed_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(end - job.started)
+            .count();
+  }
+
+  return true;
+}
+
+JobService::UserLock::UserLock(const std::string& user) : user(user) {
+  JobTable& t = table();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  if (t.activeUsers.count(user)) {
+    throw JobConflictError("Another job is in progress for this user");
+  }
+  t.activeUsers.insert(user);
+}
+
+JobService::UserLock::~UserLock() {
+  JobTable& t = table();
+  std::lock_guard<std::mutex> lock(t.mutex);
+  t.activeUsers.erase(user);
+}
+
+const char* JobService::stateName(JobState state) {
+  switch (state) {
+    case JobState::Queued:
+      return "queued";
+    case JobState::Running:
+      return "running";
+    case JobState::Succeeded:
+      return "succeeded";
+    case JobState::Failed:
+      return "failed";
+  }
+  return "unknown";
+}
+
+}  // namespace services
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace services {
+
+enum class JobState { Queued, Running, Succeeded, Failed };
+
+struct JobStatus {
+  std::string id;
+  std::string type;
+  std::string user;
+  JobState state;
+  uint64_t bytes;
+  int64_t elapsed_ms;
+  std::string message;
+};
+
+// 같은 user에 대해 이미 진행 중인 job이 있는 경우
+class JobConflictError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+// In-memory job table + 전용 worker pool
+class JobService {
+ public:
+  // progress: 처리한 byte 수를 job이 직접 갱신
+  using Task = std::function<std::string(std::atomic<uint64_t>& progress)>;
+
+  static std::string submit(const std::string& type, const std::string& user,
+                            Task task);
+  static bool find(const std::string& id, JobStatus& status);
+  static const char* stateName(JobState state);
+
+  // Job 외부(streaming 요청 등)에서 workspace를 사용하는 동안
+  // 같은 user의 job 실행을 막음 (사용 중이면 JobConflictError)
+  class UserLock {
+   public:
+    explicit UserLock(const std::string& user);
+    ~UserLock();
+
+    UserLock(const UserLock&) = delete;
+    UserLock& operator=(const UserLock&) = delete;
+
+   private:
+    std::string user;
+  };
+};
+
+}  // namespace services
@@ -3,147 +3,1184 @@
 #include <archive.h>
 #include <archive_entry.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <plog/Log.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "../codecs/memberArchive.h"
 #include "../utils/config.h"
+#include "../utils/excludeMatcher.h"
+#include "../utils/filePrefetcher.h"
+#include "../utils/manifest.h"
+#include "../utils/treeHash.h"
+#include "../utils/treeWriter.h"
+#include "changeTracker.h"
+#include "chunkStore.h"
+
+#ifndef RENAME_EXCHANGE
+#define RENAME_EXCHANGE (1 << 1)
+#endif
 
 namespace fs = std::filesystem;
 
 namespace services {
 
-static void addDirToArchive(archive* a, const std::string& path,
-                            const std::string& prefix, int depth = 0) {
-  // Recursion depth 제한
-  if (depth > Config::MAX_RECURSION_DEPTH) {
-    throw std::runtime_error("Maximum directory depth exceeded");
+// fd에 전체 buffer 기록 (partial write 처리)
+static void writeAll(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    ssize_t n = write(fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      throw std::runtime_error("Failed to write output: " +
+                               std::string(strerror(errno)));
+    }
+    data += n;
+    len -= static_cast<size_t>(n);
   }
+}
 
-  DIR* dir = opendir(path.c_str());
-  if (!dir) {
-    throw std::runtime_error("Cannot open directory");
+// Workspace tree를 archive에 추가 (이름순)
+// 다음 file들은 FilePrefetcher가 미리 읽어 두므로 read와 압축이 겹침
+// hash: 기록한 entry의 fingerprint, manifest: scan한 entry 목록
+// base: 있으면 base 이후 바뀐 entry만 기록 (모두 nullptr 허용)
+// prune: 제외할 entry (scan 단계에서 subtree째 건너뜀)
+// scanned: 있으면 tree를 다시 scan하지 않고 이 entry 목록을 기록
+static void addDirToArchive(archive* a, const std::string& path,
+                            const std::string& prefix,
+                            utils::ReadOrder order, utils::TreeHash* hash,
+                            utils::Manifest* manifest,
+                            const utils::Manifest* base,
+                            const utils::ScanPrune& prune,
+                            std::atomic<uint64_t>* progress,
+                            std::vector<utils::ScanEntry>* scanned_list) {
+  utils::FilePrefetcher::Filter filter;
+  if (base) {
+    filter = [base](const utils::ScanEntry& entry) {
+      return base->changed(entry);
+    };
   }
+  std::unique_ptr<utils::FilePrefetcher> prefetcher =
+      scanned_list ? std::make_unique<utils::FilePrefetcher>(
+                         path, std::move(*scanned_list), order, filter)
+                   : std::make_unique<utils::FilePrefetcher>(path, order,
+                                                             filter, prune);
+  utils::FilePrefetcher& files = *prefetcher;
+  utils::ScanEntry scanned;
+
+  while (files.next(scanned)) {
+    if (hash) {
+      hash->add(scanned);
+    }
+    if (manifest) {
+      manifest->add(scanned);
+    }
+    if (base && !base->changed(scanned)) {
+      continue;
+    }
 
-  try {
-    struct dirent* ent;
-    while ((ent = readdir(dir))) {
-      std::string name = ent->d_name;
-      if (name == "." || name == "..") {
-        continue;
-      }
+    std::string arch = prefix + "/" + scanned.path;
 
-      std::string full = path + "/" + name;
-      std::string arch = prefix + "/" + name;
-      struct stat st;
+    // Entry 생성
+    archive_entry* entry = archive_entry_new();
+    if (!entry) {
+      throw std::runtime_error("Failed to create archive entry");
+    }
 
-      // lstat: symlink 따라가지 않음
-      if (lstat(full.c_str(), &st) != 0) {
-        continue;
-      }
+    archive_entry_set_pathname(entry, arch.c_str());
+    archive_entry_copy_stat(entry, &scanned.st);
 
-      // Symlink skip
-      if (S_ISLNK(st.st_mode)) {
-        continue;
+    // Header 쓰기
+    if (archive_write_header(a, entry) != ARCHIVE_OK) {
+      archive_entry_free(entry);
+      throw std::runtime_error("Failed to write archive header");
+    }
+    archive_entry_free(entry);
+
+    // Regular file: data 쓰기
+    if (S_ISREG(scanned.st.st_mode)) {
+      const char* data;
+      size_t len;
+      while (files.read(data, len)) {
+        ssize_t written = archive_write_data(a, data, len);
+        if (written < 0) {
+          throw std::runtime_error("Failed to write archive data");
+        }
+        if (progress) {
+          *progress += written;
+        }
       }
+    }
+  }
+}
 
-      // Entry 생성
-      archive_entry* entry = archive_entry_new();
-      if (!entry) {
-        throw std::runtime_error("Failed to create archive entry");
-      }
+// Workspace 밖의 metadata entry (incremental archive 표시용)
+static void writeMember(archive* a, const char* name,
+                        const std::string& data) {
+  archive_entry* entry = archive_entry_new();
+  if (!entry) {
+    throw std::runtime_error("Failed to create archive entry");
+  }
 
-      archive_entry_set_pathname(entry, arch.c_str());
-      archive_entry_copy_stat(entry, &st);
+  archive_entry_set_pathname(entry, name);
+  archive_entry_set_filetype(entry, AE_IFREG);
+  archive_entry_set_perm(entry, 0600);
+  archive_entry_set_size(entry, static_cast<la_int64_t>(data.size()));
+  archive_entry_set_mtime(entry, time(nullptr), 0);
+
+  int r = archive_write_header(a, entry);
+  archive_entry_free(entry);
+  if (r != ARCHIVE_OK ||
+      archive_write_data(a, data.data(), data.size()) < 0) {
+    throw std::runtime_error("Failed to write archive header");
+  }
+}
 
-      // Header 쓰기
-      if (archive_write_header(a, entry) != ARCHIVE_OK) {
-        archive_entry_free(entry);
-        throw std::runtime_error("Failed to write archive header");
-      }
+static std::string manifestPath(const std::string& base,
+                                const std::string& id) {
+  return base + Config::PATH_MANIFESTS + "/" + id;
+}
 
-      // Regular file: data 쓰기
-      if (S_ISREG(st.st_mode)) {
-        std::ifstream file(full, std::ios::binary);
-        char buf[Config::FILE_BUFFER_SIZE];
-        while (file.read(buf, sizeof(buf)) || file.gcount() > 0) {
-          ssize_t written = archive_write_data(a, buf, file.gcount());
-          if (written < 0) {
-            archive_entry_free(entry);
-            throw std::runtime_error("Failed to write archive data");
-          }
-        }
-      }
+// 이전 member archive (fd -1: 없음)
+struct MemberReuse {
+  int fd = -1;
+  codecs::MemberIndex previous;
+  codecs::MemberIndex written;  // 새 archive의 index
+};
+
+// options.members: entry마다 MemberArchiveWriter로 전달
+// 이전 archive에서 복사할 큰 file은 읽지 않음
+// scanned_list: addDirToArchive와 같음
+static void writeMemberArchive(const std::string& workspace,
+                               const codecs::CodecOptions& options,
+                               const codecs::ArchiveOutput::Sink& sink,
+                               std::atomic<uint64_t>* progress,
+                               utils::TreeHash* hash,
+                               utils::Manifest* manifest,
+                               const utils::ScanPrune& prune,
+                               MemberReuse* reuse,
+                               std::vector<utils::ScanEntry>* scanned_list) {
+  codecs::MemberArchiveWriter writer(
+      options, sink, reuse ? reuse->fd : -1,
+      reuse ? std::move(reuse->previous) : codecs::MemberIndex());
+
+  utils::FilePrefetcher::Filter filter =
+      [&writer](const utils::ScanEntry& entry) {
+        return !writer.reusable("workspace/" + entry.path, entry.st);
+      };
+  std::unique_ptr<utils::FilePrefetcher> prefetcher =
+      scanned_list
+          ? std::make_unique<utils::FilePrefetcher>(
+                workspace, std::move(*scanned_list), options.read_order,
+                filter)
+          : std::make_unique<utils::FilePrefetcher>(
+                workspace, options.read_order, filter, prune);
+  utils::FilePrefetcher& files = *prefetcher;
+  utils::ScanEntry scanned;
+
+  while (files.next(scanned)) {
+    if (hash) {
+      hash->add(scanned);
+    }
+    if (manifest) {
+      manifest->add(scanned);
+    }
 
-      archive_entry_free(entry);
+    std::string arch = "workspace/" + scanned.path;
+    if (progress && writer.reusable(arch, scanned.st)) {
+      *progress += static_cast<uint64_t>(scanned.st.st_size);
+    }
+    writer.add(arch, scanned.st,
+               [&files, progress](const char*& data, size_t& len) {
+                 if (!files.read(data, len)) {
+                   return false;
+                 }
+                 if (progress) {
+                   *progress += len;
+                 }
+                 return true;
+               });
+  }
+
+  writer.finish();
+  if (reuse) {
+    reuse->written = writer.index();
+  }
+}
+
+// Exclude pattern이 없으면 nullptr (exclude는 scan이 끝날 때까지 유지)
+static utils::ScanPrune excludePrune(const utils::ExcludeMatcher& exclude) {
+  if (exclude.empty()) {
+    return nullptr;
+  }
+  return [&exclude](const std::string& path, bool is_dir) {
+    return exclude.excluded(path, is_dir);
+  };
+}
+
+// .workspaceignore의 pattern을 요청 pattern 앞에 추가
+// (나중 pattern이 우선이므로 요청에서 "!"로 다시 포함 가능)
+static codecs::CodecOptions withIgnoreFile(const std::string& base,
+                                           codecs::CodecOptions options) {
+  std::ifstream file(base + Config::PATH_IGNORE);
+  std::vector<std::string> patterns;
+  std::string line;
+  while (std::getline(file, line)) {
+    patterns.push_back(line);
+  }
+  if (patterns.size() > Config::MAX_EXCLUDE_PATTERNS) {
+    throw std::runtime_error("Too many patterns in .workspaceignore");
+  }
+  patterns.insert(patterns.end(), options.exclude.begin(),
+                  options.exclude.end());
+  options.exclude = std::move(patterns);
+  return options;
+}
+
+// Workspace를 archive로 만들어 압축된 byte를 sink로 출력
+// options.base가 있으면 incremental archive:
+//   DELTA_HEADER, 바뀐 entry, DELTA_DELETED(삭제 경로, '\0' 구분) 순
+// scanned: 이미 scan한 workspace entry (있으면 다시 scan하지 않음)
+static void writeArchive(const std::string& base,
+                         const codecs::CodecOptions& options,
+                         const codecs::ArchiveOutput::Sink& sink,
+                         std::atomic<uint64_t>* progress,
+                         utils::TreeHash* hash = nullptr,
+                         utils::Manifest* manifest = nullptr,
+                         MemberReuse* members = nullptr,
+                         std::vector<utils::ScanEntry>* scanned = nullptr) {
+  std::string workspace = base + Config::PATH_WORKSPACE;
+  utils::ExcludeMatcher exclude(options.exclude);
+  utils::ScanPrune prune = excludePrune(exclude);
+  if (options.members) {
+    writeMemberArchive(workspace, options, sink, progress, hash, manifest,
+                       prune, members, scanned);
+    return;
+  }
+
+  bool delta = !options.base.empty();
+  utils::Manifest base_manifest;
+  utils::Manifest current;
+  if (delta) {
+    if (!base_manifest.load(manifestPath(base, options.base))) {
+      throw std::runtime_error("Base snapshot not found");
+    }
+    if (!manifest) {
+      manifest = &current;
+    }
+  }
+
+  codecs::ArchiveOutput out(options, sink);
+
+  archive* a = archive_write_new();
+  if (!a) {
+    throw std::runtime_error("Failed to create archive");
+  }
+
+  try {
+    // pax format + 요청된 codec
+    archive_write_set_format_pax_restricted(a);
+    out.open(a);
 
-      // Directory: 재귀
-      if (S_ISDIR(st.st_mode)) {
-        addDirToArchive(a, full, arch, depth + 1);
+    if (delta) {
+      // Extract하는 쪽은 layout id로 같은 base 위에 적용하는지 확인
+      writeMember(a, Config::DELTA_HEADER,
+                  "base " + options.base + " " + base_manifest.layoutId() +
+                      "\n");
+    }
+
+    addDirToArchive(a, workspace, "workspace", options.read_order, hash,
+                    manifest, delta ? &base_manifest : nullptr, prune,
+                    progress, scanned);
+
+    if (delta) {
+      std::string deleted;
+      for (const std::string& path : base_manifest.removedIn(*manifest)) {
+        deleted += path;
+        deleted += '\0';
       }
+      writeMember(a, Config::DELTA_DELETED, deleted);
     }
-    closedir(dir);
+
+    if (archive_write_close(a) != ARCHIVE_OK) {
+      throw std::runtime_error("Failed to finalize archive: " +
+                               std::string(archive_error_string(a)));
+    }
+    archive_write_free(a);
   } catch (...) {
-    closedir(dir);
+    out.cancel();
+    archive_write_free(a);
     throw;
   }
 }
 
-// Compress: workspace -> tgz
-std::string WorkspaceService::compress(const std::string& user) {
+// Snapshot manifest 저장 후 오래된 manifest 정리 (실패해도 compress는 성공)
+static void saveManifest(const std::string& base,
+                         const utils::Manifest& manifest) {
+  std::string dir = base + Config::PATH_MANIFESTS;
+  std::string path = manifestPath(base, manifest.id());
+  std::error_code ec;
+  try {
+    fs::create_directories(dir);
+    manifest.save(path + ".tmp");
+    fs::rename(path + ".tmp", path);
+  } catch (const std::exception& e) {
+    PLOGW << "Failed to save manifest " << path << ": " << e.what();
+    fs::remove(path + ".tmp", ec);
+    return;
+  }
+
+  std::vector<std::pair<fs::file_time_type, fs::path>> saved;
+  for (const auto& entry : fs::directory_iterator(dir, ec)) {
+    auto time = entry.last_write_time(ec);
+    if (!ec) {
+      saved.emplace_back(time, entry.path());
+    }
+  }
+  if (saved.size() <= Config::MAX_MANIFESTS) {
+    return;
+  }
+  std::sort(saved.begin(), saved.end());
+  for (size_t i = 0; i + Config::MAX_MANIFESTS < saved.size(); ++i) {
+    fs::remove(saved[i].second, ec);
+  }
+}
+
+// Fingerprint 시작 값: archive 내용에 영향을 주는 option
+// (threads, read_order는 결과 byte와 무관하므로 제외)
+static utils::TreeHash seedHash(const codecs::CodecOptions& options) {
+  utils::TreeHash hash;
+  hash.add(codecs::codecName(options.codec));
+  hash.add(options.base);
+  int values[] = {options.level, options.long_range ? 1 : 0,
+                  options.members ? 1 : 0};
+  hash.add(values, sizeof(values));
+  for (const std::string& pattern : options.exclude) {
+    hash.add(pattern);
+  }
+  return hash;
+}
+
+// Fingerprint 파일: "<hash> <size> <mtime_ns> <output filename> <snapshot>"
+// output이 그 뒤에 바뀌지 않았는지 size/mtime으로 함께 확인
+static bool outputStat(const std::string& output, uint64_t& size,
+                       int64_t& mtime_ns) {
+  struct stat st;
+  if (stat(output.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+    return false;
+  }
+  size = static_cast<uint64_t>(st.st_size);
+  mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+             st.st_mtim.tv_nsec;
+  return true;
+}
+
+static bool matchesFingerprint(const std::string& path,
+                               const std::string& hash,
+                               const std::string& output,
+                               std::string& snapshot) {
+  std::ifstream file(path);
+  std::string saved_hash, saved_name;
+  uint64_t saved_size;
+  int64_t saved_mtime;
+  if (!(file >> saved_hash >> saved_size >> saved_mtime >> saved_name >>
+        snapshot)) {
+    return false;
+  }
+
+  uint64_t size;
+  int64_t mtime_ns;
+  return saved_hash == hash &&
+         saved_name == fs::path(output).filename().string() &&
+         outputStat(output, size, mtime_ns) && size == saved_size &&
+         mtime_ns == saved_mtime;
+}
+
+static void saveFingerprint(const std::string& path, const std::string& hash,
+                            const std::string& output,
+                            const std::string& snapshot) {
+  uint64_t size;
+  int64_t mtime_ns;
+  if (!outputStat(output, size, mtime_ns)) {
+    return;
+  }
+
+  // 임시 파일에 쓴 뒤 rename (중간 상태의 fingerprint 방지)
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream file(tmp, std::ios::trunc);
+    file << hash << " " << size << " " << mtime_ns << " "
+         << fs::path(output).filename().string() << " " << snapshot << "\n";
+    if (!file) {
+      return;
+    }
+  }
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+}
+
+// 마지막으로 계산한 fingerprint와 당시 change tracker generation
+// generation이 그대로면 workspace를 다시 scan하지 않고 재사용
+struct KnownFingerprint {
+  uint64_t generation;
+  std::string seed;
+  std::string hash;
+};
+
+static std::mutex knownMutex;
+static std::unordered_map<std::string, KnownFingerprint> knownFingerprints;
+
+static bool knownFingerprint(const std::string& user, uint64_t generation,
+                             const std::string& seed, std::string& hash) {
+  std::lock_guard<std::mutex> lock(knownMutex);
+  auto it = knownFingerprints.find(user);
+  if (it == knownFingerprints.end() || it->second.generation != generation ||
+      it->second.seed != seed) {
+    return false;
+  }
+  hash = it->second.hash;
+  return true;
+}
+
+static void rememberFingerprint(const std::string& user, uint64_t generation,
+                                const std::string& seed,
+                                const std::string& hash) {
+  std::lock_guard<std::mutex> lock(knownMutex);
+  knownFingerprints[user] = KnownFingerprint{generation, seed, hash};
+}
+
+// Member index 파일: "<seed> <output size> <mtime_ns>" 다음 줄부터
+// "<segment key> <offset> <length>" (seed가 다르면 재사용하지 않음)
+static void loadMemberIndex(const std::string& path, const std::string& seed,
+                            const std::string& output, MemberReuse& reuse) {
+  std::ifstream file(path);
+  std::string saved_seed;
+  uint64_t saved_size;
+  int64_t saved_mtime;
+  if (!(file >> saved_seed >> saved_size >> saved_mtime) ||
+      saved_seed != seed) {
+    return;
+  }
+
+  codecs::MemberIndex index;
+  uint64_t key;
+  codecs::MemberSegment segment;
+  while (file >> key >> segment.offset >> segment.length) {
+    index[key] = segment;
+  }
+  if (!file.eof()) {
+    return;
+  }
+
+  // Index를 저장한 뒤 output이 바뀌지 않았는지 확인
+  int fd = open(output.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd < 0) {
+    return;
+  }
+  if (fstat(fd, &st) != 0 ||
+      static_cast<uint64_t>(st.st_size) != saved_size ||
+      static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+              st.st_mtim.tv_nsec !=
+          saved_mtime) {
+    close(fd);
+    return;
+  }
+
+  reuse.fd = fd;
+  reuse.previous = std::move(index);
+}
+
+static void saveMemberIndex(const std::string& path, const std::string& seed,
+                            const std::string& output,
+                            const codecs::MemberIndex& index) {
+  uint64_t size;
+  int64_t mtime_ns;
+  if (!outputStat(output, size, mtime_ns)) {
+    return;
+  }
+
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream file(tmp, std::ios::trunc);
+    file << seed << " " << size << " " << mtime_ns << "\n";
+    for (const auto& entry : index) {
+      file << entry.first << " " << entry.second.offset << " "
+           << entry.second.length << "\n";
+    }
+    if (!file) {
+      return;
+    }
+  }
+  std::error_code ec;
+  fs::rename(tmp, path, ec);
+}
+
+// Input archive 검색 (codec은 libarchive가 내용으로 판별)
+// 여러 개가 있으면 가장 최근 파일 사용
+static std::string findInput(const std::string& base) {
+  std::string found;
+  fs::file_time_type found_time;
+
+  for (codecs::Codec codec : codecs::ALL_CODECS) {
+    std::string path =
+        base + Config::PATH_INPUT + codecs::codecExtension(codec);
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    if (ec) {
+      continue;
+    }
+    if (found.empty() || time > found_time) {
+      found = path;
+      found_time = time;
+    }
+  }
+
+  return found;
+}
+
+// Compress: workspace -> archive
+std::string WorkspaceService::compress(const std::string& user,
+                                       const codecs::CodecOptions& requested,
+                                       std::atomic<uint64_t>* progress) {
   std::string base = Config::PATH_HOME_BASE + user;
   std::string workspace = base + Config::PATH_WORKSPACE;
-  std::string output = base + Config::PATH_OUTPUT;
+  codecs::CodecOptions options = withIgnoreFile(base, requested);
+  std::string output = base + Config::PATH_OUTPUT +
+                       codecs::codecExtension(options.codec);
 
   if (!fs::exists(workspace)) {
     throw std::runtime_error("Workspace directory does not exist");
   }
+  // 기존 output을 지우기 전에 확인
+  if (!options.base.empty() && !fs::exists(manifestPath(base, options.base))) {
+    throw std::runtime_error("Base snapshot not found");
+  }
+
+  // 변경 추적 중이면 scan 전에 generation 기록
+  // (이후 변경은 generation을 올리므로 결과가 재사용되지 않음)
+  WorkspaceChanges changes;
+  bool tracked = ChangeTracker::watch(user) &&
+                 ChangeTracker::changes(user, changes);
+  std::string seed = seedHash(options).hex();
+
+  // 마지막 archive 이후 workspace가 그대로면 기존 output 재사용
+  // (metadata만 scan하므로 압축보다 훨씬 빠름)
+  // Scan한 entry는 보관해 두고 archive를 쓸 때 그대로 사용 (walk 한 번)
+  std::string fingerprint = base + Config::PATH_FINGERPRINT;
+  std::string current_hash;
+  std::vector<utils::ScanEntry> scanned;
+  bool rescanned = false;
+  if (!tracked ||
+      !knownFingerprint(user, changes.generation, seed, current_hash)) {
+    utils::TreeHash current = seedHash(options);
+    utils::ExcludeMatcher exclude(options.exclude);
+    utils::scanTree(
+        workspace, Config::SCAN_THREADS,
+        [&current, &scanned](const utils::ScanEntry& entry) {
+          current.add(entry);
+          scanned.push_back(entry);
+        },
+        excludePrune(exclude));
+    rescanned = true;
+    current_hash = current.hex();
+    if (tracked) {
+      rememberFingerprint(user, changes.generation, seed, current_hash);
+    }
+  }
+  std::string snapshot;
+  if (matchesFingerprint(fingerprint, current_hash, output, snapshot)) {
+    return "Compressed: " + fs::path(output).filename().string() +
+           " (cached, snapshot " + snapshot + ")";
+  }
 
-  fs::remove(output);
+  // Member archive: 삭제 전에 이전 output을 열어 둠 (unlink 후에도 읽기 가능)
+  MemberReuse members;
+  std::string member_index = base + Config::PATH_MEMBER_INDEX;
+  if (options.members) {
+    loadMemberIndex(member_index, seed, output, members);
+  }
 
-  archive* a = archive_write_new();
-  if (!a) {
-    throw std::runtime_error("Failed to create archive");
+  // 이전 output 제거 (codec과 무관하게 하나만 유지)
+  fs::remove(fingerprint);
+  fs::remove(member_index);
+  for (codecs::Codec codec : codecs::ALL_CODECS) {
+    fs::remove(base + Config::PATH_OUTPUT + codecs::codecExtension(codec));
+  }
+
+  int fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  if (fd < 0) {
+    if (members.fd >= 0) {
+      close(members.fd);
+    }
+    throw std::runtime_error("Failed to open output");
   }
 
+  // 실제로 기록한 entry 기준 fingerprint (scan을 건너뛴 경우 이후 변경 반영)
+  utils::TreeHash archived = seedHash(options);
+  utils::Manifest manifest;
   try {
-    // gzip + pax format
-    archive_write_add_filter_gzip(a);
-    archive_write_set_format_pax_restricted(a);
+    writeArchive(
+        base, options,
+        [fd](const char* data, size_t len) { writeAll(fd, data, len); },
+        progress, &archived, &manifest, &members,
+        rescanned ? &scanned : nullptr);
+  } catch (...) {
+    close(fd);
+    if (members.fd >= 0) {
+      close(members.fd);
+    }
+    fs::remove(output);
+    throw;
+  }
+  if (members.fd >= 0) {
+    close(members.fd);
+  }
+
+  if (close(fd) != 0) {
+    fs::remove(output);
+    throw std::runtime_error("Failed to close output");
+  }
+
+  // Permission 644
+  if (chmod(output.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0) {
+    return "Archive created successfully, but failed to set permissions to "
+           "644. File may have restricted access.";
+  }
+
+  // 이후 incremental compress의 base로 사용할 수 있도록 manifest 저장
+  saveManifest(base, manifest);
+  saveFingerprint(fingerprint, archived.hex(), output, manifest.id());
+  if (options.members) {
+    saveMemberIndex(member_index, seed, output, members.written);
+  }
+  if (tracked) {
+    rememberFingerprint(user, changes.generation, seed, archived.hex());
+    ChangeTracker::clearDirty(user, changes.generation);
+  }
+  return "Compressed: " + fs::path(output).filename().string() +
+         " (snapshot " + manifest.id() + ")";
+}
+
+// Stream: workspace -> sink (임시 파일 없이 바로 전송)
+void WorkspaceService::stream(const std::string& user,
+                              const codecs::CodecOptions& options,
+                              const codecs::ArchiveOutput::Sink& sink,
+                              std::atomic<uint64_t>* progress) {
+  std::string base = Config::PATH_HOME_BASE + user;
+
+  if (!fs::exists(base + Config::PATH_WORKSPACE)) {
+    throw std::runtime_error("Workspace directory does not exist");
+  }
+
+  writeArchive(base, withIgnoreFile(base, options), sink, progress);
+}
+
+// Stream 입력용 libarchive read callback 상태
+struct StreamInput {
+  const WorkspaceService::Source* source;
+  std::vector<char> buffer;
+  size_t total;
+};
 
-    if (archive_write_open_filename(a, output.c_str()) != ARCHIVE_OK) {
-      throw std::runtime_error("Failed to open output");
+static la_ssize_t streamReadCallback(archive* a, void* client_data,
+                                     const void** buffer) {
+  auto* input = static_cast<StreamInput*>(client_data);
+  try {
+    size_t n = (*input->source)(input->buffer.data(), input->buffer.size());
+
+    // Zip Bomb 방어: 읽은 archive size 제한
+    input->total += n;
+    if (input->total > Config::MAX_ARCHIVE_SIZE) {
+      archive_set_error(a, EFBIG, "Archive file too large");
+      return -1;
     }
 
-    addDirToArchive(a, workspace, "workspace");
+    *buffer = input->buffer.data();
+    return static_cast<la_ssize_t>(n);
+  } catch (const std::exception& e) {
+    archive_set_error(a, EIO, "%s", e.what());
+    return -1;
+  }
+}
 
-    archive_write_close(a);
-    archive_write_free(a);
+// Background에서 삭제 중인 경로 (같은 tree를 여러 thread가 지우지 않도록)
+static std::mutex removingMutex;
+static std::unordered_set<std::string> removing;
 
-    // Permission 644
-    if (chmod(output.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0) {
-      return "Archive created successfully, but failed to set permissions to "
-             "644. File may have restricted access.";
+// Extract 후 남은 staging directory 삭제 (요청 thread를 막지 않음)
+static void removeInBackground(const std::string& path) {
+  {
+    std::lock_guard<std::mutex> lock(removingMutex);
+    if (!removing.insert(path).second) {
+      return;
     }
+  }
 
-    return "Compressed";
+  std::thread([path]() {
+    std::error_code ec;
+    fs::remove_all(path, ec);
+    if (ec) {
+      PLOGW << "Failed to remove " << path << ": " << ec.message();
+    }
+    std::lock_guard<std::mutex> lock(removingMutex);
+    removing.erase(path);
+  }).detach();
+}
+
+// 종료 등으로 삭제되지 못한 이전 staging directory 정리
+// (user lock 보유 상태에서 호출되므로 진행 중인 extract와 겹치지 않고,
+// 이미 삭제 중인 경로는 removeInBackground에서 건너뜀)
+static void removeStaleStaging(const std::string& base) {
+  std::string prefix = fs::path(Config::PATH_STAGING).filename().string();
+  std::error_code ec;
+  for (const auto& entry : fs::directory_iterator(base, ec)) {
+    std::string name = entry.path().filename().string();
+    if (name.compare(0, prefix.size(), prefix) == 0) {
+      removeInBackground(entry.path().string());
+    }
+  }
+}
+
+// from을 to 위치로 이동하고, 기존 to는 from 위치로 이동
+// RENAME_EXCHANGE를 지원하지 않는 filesystem은 rename 두 번으로 대체
+static void swapDirectories(const std::string& from, const std::string& to) {
+  if (syscall(SYS_renameat2, AT_FDCWD, from.c_str(), AT_FDCWD, to.c_str(),
+              RENAME_EXCHANGE) == 0) {
+    return;
+  }
+
+  if (errno == ENOENT && access(to.c_str(), F_OK) != 0) {
+    // 기존 workspace 없음
+    if (rename(from.c_str(), to.c_str()) != 0) {
+      throw std::runtime_error("Failed to install workspace: " +
+                               std::string(strerror(errno)));
+    }
+    return;
+  }
+
+  if (errno != EINVAL && errno != ENOSYS) {
+    throw std::runtime_error("Failed to swap workspace: " +
+                             std::string(strerror(errno)));
+  }
+
+  std::string old = from + ".old";
+  if (rename(to.c_str(), old.c_str()) != 0) {
+    throw std::runtime_error("Failed to swap workspace: " +
+                             std::string(strerror(errno)));
+  }
+  if (rename(from.c_str(), to.c_str()) != 0) {
+    int err = errno;
+    rename(old.c_str(), to.c_str());
+    throw std::runtime_error("Failed to install workspace: " +
+                             std::string(strerror(err)));
+  }
+  rename(old.c_str(), from.c_str());
+}
+
+// 복제한 file에 원본의 소유자/mode/시각 적용
+// (소유자를 바꾸지 못하면 setuid/setgid는 제외)
+static void copyAttributes(int fd, const struct stat& st) {
+  struct timespec times[2] = {st.st_atim, st.st_mtim};
+  futimens(fd, times);
+  mode_t mask = 07777;
+  if (fchown(fd, st.st_uid, st.st_gid) != 0) {
+    mask = 01777;
+  }
+  fchmod(fd, st.st_mode & mask);
+}
+
+// Reflink(FICLONE)로 data block을 공유하는 독립 file 생성
+// 지원하지 않는 filesystem이면 false (이후 시도 생략)
+static bool reflinkFile(int from, int to, const char* name,
+                        const struct stat& st) {
+  static std::atomic<bool> unsupported{false};
+  if (unsupported) {
+    return false;
+  }
+
+  int in = openat(from, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (in < 0) {
+    return false;
+  }
+  int out = openat(to, name, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (out < 0) {
+    close(in);
+    return false;
+  }
+
+  bool cloned = ioctl(out, FICLONE, in) == 0;
+  if (cloned) {
+    copyAttributes(out, st);
+  } else {
+    if (errno == EOPNOTSUPP || errno == EXDEV || errno == EINVAL ||
+        errno == ENOTTY) {
+      unsupported = true;
+    }
+    unlinkat(to, name, 0);
+  }
+  close(out);
+  close(in);
+  return cloned;
+}
+
+// from의 file name을 to에 복사 (copy_file_range, 미지원 시 read/write)
+static void copyFile(int from, int to, const char* name,
+                     const struct stat& st) {
+  int in = openat(from, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (in < 0) {
+    throw std::runtime_error("Failed to open " + std::string(name) + ": " +
+                             strerror(errno));
+  }
+  int out = openat(to, name, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (out < 0) {
+    int err = errno;
+    close(in);
+    throw std::runtime_error("Failed to create " + std::string(name) + ": " +
+                             strerror(err));
+  }
+
+  try {
+    std::vector<char> buffer;
+    ssize_t n;
+    do {
+      if (buffer.empty()) {
+        n = copy_file_range(in, nullptr, out, nullptr, Config::COPY_CHUNK_SIZE,
+                            0);
+        // 다른 filesystem 등: 이어서 read/write로 복사
+        if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL ||
+                      errno == EOPNOTSUPP)) {
+          buffer.resize(Config::CHUNK_BUFFER_SIZE);
+          n = 1;
+        }
+      } else {
+        n = read(in, buffer.data(), buffer.size());
+        if (n > 0) {
+          writeAll(out, buffer.data(), static_cast<size_t>(n));
+        }
+      }
+    } while (n > 0 || (n < 0 && errno == EINTR));
+    if (n < 0) {
+      throw std::runtime_error("Failed to copy " + std::string(name) + ": " +
+                               strerror(errno));
+    }
   } catch (...) {
-    archive_write_close(a);
-    archive_write_free(a);
+    close(out);
+    close(in);
+    throw;
+  }
+
+  copyAttributes(out, st);
+  close(out);
+  close(in);
+}
+
+// cloneTree 진행 상태
+struct CloneState {
+  bool copy;  // true: reflink 미지원 시 hardlink 대신 복사
+  std::atomic<uint64_t>* progress;
+  uint64_t cloned = 0;
+  uint64_t links = 0;  // hardlink한 file 수
+};
+
+static void cloneDir(int from, int to, int depth, CloneState& state);
+
+// from의 entry name 하나를 to에 복제 (symlink는 따라가지 않고 그대로 생성)
+static void cloneEntry(int from, int to, const char* name, int depth,
+                       CloneState& state) {
+  struct stat st;
+  if (fstatat(from, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+    throw std::runtime_error("Failed to stat " + std::string(name) + ": " +
+                             std::string(strerror(errno)));
+  }
+
+  if (S_ISDIR(st.st_mode)) {
+    if (mkdirat(to, name, 0700) != 0) {
+      throw std::runtime_error("Failed to create directory: " +
+                               std::string(strerror(errno)));
+    }
+    int dst = openat(to, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    int src = openat(from, name,
+                     O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (src < 0 || dst < 0) {
+      int err = errno;
+      if (src >= 0) close(src);
+      if (dst >= 0) close(dst);
+      throw std::runtime_error("Failed to open directory " +
+                               std::string(name) + ": " + strerror(err));
+    }
+    try {
+      cloneDir(src, dst, depth + 1, state);
+    } catch (...) {
+      close(dst);
+      throw;
+    }
+    // 쓰기 권한이 없는 directory도 채울 수 있도록 mode는 채운 뒤 복원
+    fchmod(dst, st.st_mode & 07777);
+    close(dst);
+  } else if (S_ISREG(st.st_mode)) {
+    state.cloned += static_cast<uint64_t>(st.st_size);
+    if (state.progress) {
+      *state.progress = state.cloned;
+    }
+    if (reflinkFile(from, to, name, st)) {
+      return;
+    }
+    if (state.copy) {
+      copyFile(from, to, name, st);
+      return;
+    }
+    if (linkat(from, name, to, name, 0) != 0) {
+      // Link 수 한도 등: 복사로 대체
+      if (errno != EMLINK && errno != EPERM && errno != EXDEV) {
+        throw std::runtime_error("Failed to link " + std::string(name) +
+                                 ": " + strerror(errno));
+      }
+      copyFile(from, to, name, st);
+      return;
+    }
+    ++state.links;
+  } else if (S_ISLNK(st.st_mode)) {
+    std::string target(static_cast<size_t>(st.st_size) + 1, '\0');
+    ssize_t n = readlinkat(from, name, &target[0], target.size());
+    if (n < 0 || static_cast<size_t>(n) >= target.size()) {
+      throw std::runtime_error("Failed to read link " + std::string(name));
+    }
+    target.resize(static_cast<size_t>(n));
+    if (symlinkat(target.c_str(), to, name) != 0) {
+      throw std::runtime_error("Failed to create link " + std::string(name) +
+                               ": " + strerror(errno));
+    }
+  } else {
+    // FIFO, socket, device (setuid/setgid bit 제외)
+    if (mknodat(to, name, st.st_mode & (S_IFMT | 01777), st.st_rdev) != 0) {
+      throw std::runtime_error("Failed to create " + std::string(name) +
+                               ": " + strerror(errno));
+    }
+  }
+}
+
+// Directory fd from의 entry를 to에 복제 (from은 닫음)
+static void cloneDir(int from, int to, int depth, CloneState& state) {
+  DIR* dir = fdopendir(from);
+  if (!dir) {
+    close(from);
+    throw std::runtime_error("Failed to read directory");
+  }
+  if (depth > Config::MAX_RECURSION_DEPTH) {
+    closedir(dir);
+    throw std::runtime_error("Maximum directory depth exceeded");
+  }
+
+  try {
+    while (dirent* d = readdir(dir)) {
+      if (strcmp(d->d_name, ".") != 0 && strcmp(d->d_name, "..") != 0) {
+        cloneEntry(dirfd(dir), to, d->d_name, depth, state);
+      }
+    }
+  } catch (...) {
+    closedir(dir);
+    throw;
+  }
+  closedir(dir);
+}
+
+// Directory fd from의 내용을 to에 복제 (file은 가능하면 reflink)
+// reflink를 지원하지 않는 filesystem이면
+//   Incremental extract: hardlink (바뀐 file은 extract 시 unlink 후 새로 생성)
+//   History 복원(copy): 복사 (hardlink는 workspace에서 file을 제자리 수정하면
+//   snapshot도 바뀜)
+// 반환: hardlink한 file 수 (0이면 from과 inode를 공유하지 않음)
+static uint64_t cloneTree(int from, const std::string& to, bool copy = false,
+                          std::atomic<uint64_t>* progress = nullptr) {
+  struct stat root_st;
+  if (fstat(from, &root_st) != 0 || !S_ISDIR(root_st.st_mode)) {
+    throw std::runtime_error("Workspace directory does not exist");
+  }
+  if (mkdir(to.c_str(), 0700) != 0) {
+    throw std::runtime_error("Failed to create directory: " +
+                             std::string(strerror(errno)));
+  }
+  int dst = open(to.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  // dup은 호출한 쪽과 directory offset을 공유하므로 새로 열기
+  int src = openat(from, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (src < 0 || dst < 0) {
+    int err = errno;
+    if (src >= 0) close(src);
+    if (dst >= 0) close(dst);
+    throw std::runtime_error("Failed to open directory: " +
+                             std::string(strerror(err)));
+  }
+
+  CloneState state{copy, progress};
+  try {
+    cloneDir(src, dst, 0, state);
+  } catch (...) {
+    close(dst);
     throw;
   }
+  fchmod(dst, root_st.st_mode & 07777);
+  close(dst);
+  return state.links;
+}
+
+// 빈 component, ".", ".." 없는 상대 경로인지
+static bool isSafeRelative(const std::string& path) {
+  if (path.empty() || path[0] == '/') {
+    return false;
+  }
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = path.find('/', start);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    std::string part = path.substr(start, end - start);
+    if (part.empty() || part == "." || part == "..") {
+      return false;
+    }
+    start = end + 1;
+  }
+  return true;
+}
+
+// 현재 entry data 전체를 읽음 (limit 초과 시 예외)
+static std::string readMember(archive* a, size_t limit) {
+  std::string data;
+  char buf[8192];
+  while (true) {
+    la_ssize_t n = archive_read_data(a, buf, sizeof(buf));
+    if (n < 0) {
+      throw std::runtime_error("Failed to read data block: " +
+                               std::string(archive_error_string(a)));
+    }
+    if (n == 0) {
+      break;
+    }
+    data.append(buf, static_cast<size_t>(n));
+    if (data.size() > limit) {
+      throw std::runtime_error("Extracted size exceeds limit");
+    }
+  }
+  return data;
+}
+
+static bool isHexId(const std::string& id) {
+  return !id.empty() && id.size() <= 64 &&
+         id.find_first_not_of("0123456789abcdef") == std::string::npos;
+}
+
+// DELTA_HEADER "base <snapshot id> <layout id>\n" (형식이 다르면 예외)
+static void deltaBase(const std::string& header, std::string& id,
+                      std::string& layout) {
+  const std::string prefix = "base ";
+  size_t space = header.find(' ', prefix.size());
+  if (header.compare(0, prefix.size(), prefix) != 0 ||
+      header.empty() || header.back() != '\n' ||
+      space == std::string::npos) {
+    throw std::invalid_argument("Invalid delta archive");
+  }
+  id = header.substr(prefix.size(), space - prefix.size());
+  layout = header.substr(space + 1, header.size() - space - 2);
+  if (!isHexId(id) || !isHexId(layout)) {
+    throw std::invalid_argument("Invalid delta archive");
+  }
+}
+
+// 현재 workspace가 delta archive의 base snapshot과 같은지
+// .workspaceignore를 적용한 layout id가 같거나, 이 workspace에서 만든
+// base manifest의 entry가 mtime까지 모두 그대로 있으면 일치
+static bool matchesBase(const std::string& base, int workspace,
+                        const std::string& id, const std::string& layout) {
+  utils::Manifest saved;
+  bool have_saved = saved.load(manifestPath(base, id));
+
+  codecs::CodecOptions options = withIgnoreFile(base, codecs::CodecOptions());
+  utils::ExcludeMatcher exclude(options.exclude);
+  utils::Manifest current;
+  size_t unchanged = 0;
+  utils::scanTree(
+      workspace, Config::SCAN_THREADS,
+      [&](const utils::ScanEntry& entry) {
+        current.add(entry);
+        if (have_saved && !saved.changed(entry)) {
+          ++unchanged;
+        }
+      },
+      excludePrune(exclude));
+
+  return current.layoutId() == layout ||
+         (have_saved && unchanged == saved.size());
+}
+
+bool WorkspaceService::openOutput(const std::string& user,
+                                  OutputFile& output) {
+  std::string base = Config::PATH_HOME_BASE + user + Config::PATH_OUTPUT;
+  bool found = false;
+
+  // compress는 output을 하나만 유지하지만 가장 최근 파일을 선택
+  for (codecs::Codec codec : codecs::ALL_CODECS) {
+    std::string path = base + codecs::codecExtension(codec);
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+      close(fd);
+      continue;
+    }
+
+    int64_t mtime_ns =
+        static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+        st.st_mtim.tv_nsec;
+    if (found && mtime_ns <= output.mtime_ns) {
+      close(fd);
+      continue;
+    }
+
+    if (found) {
+      close(output.fd);
+    }
+    output.fd = fd;
+    output.filename = fs::path(path).filename().string();
+    output.codec = codec;
+    output.size = static_cast<uint64_t>(st.st_size);
+    output.mtime_ns = mtime_ns;
+    found = true;
+  }
+
+  return found;
 }
 
-// Extract: tgz -> workspace
-std::string WorkspaceService::extract(const std::string& user) {
+// Extract: archive -> workspace
+std::string WorkspaceService::extract(const std::string& user,
+                                      SyncMode sync,
+                                      std::atomic<uint64_t>* progress) {
   std::string base = Config::PATH_HOME_BASE + user;
-  std::string workspace = base + Config::PATH_WORKSPACE;
-  std::string input = base + Config::PATH_INPUT;
+  std::string input = findInput(base);
 
-  if (!fs::exists(input)) {
+  if (input.empty()) {
     throw std::runtime_error("Archive file does not exist");
   }
 
@@ -155,50 +1192,487 @@ std::string WorkspaceService::extract(const std::string& user) {
 
   chmod(input.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
 
-  // Workspace 존재 여부 확인 및 백업 처리
-  bool backup_created = false;
-  std::string backup_path;
+  std::string message = extractArchive(
+      user,
+      [&input](archive* a) {
+        return archive_read_open_filename(a, input.c_str(),
+                                          Config::ARCHIVE_BLOCK_SIZE);
+      },
+      sync, progress);
 
-  if (fs::exists(workspace)) {
-    // Backup path 생성
-    auto now = std::chrono::system_clock::now();
-    auto timestamp =
-        std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch())
-            .count();
-    backup_path = std::string(Config::PATH_BACKUP_BASE) + "_" + user + "_" +
-                  std::to_string(timestamp);
+  fs::remove(input);
+  return message;
+}
 
-    // Workspace backup
-    std::error_code ec;
-    fs::rename(workspace, backup_path, ec);
+// Extract: stream -> workspace (archive 파일 없이 바로 해제)
+std::string WorkspaceService::extractFrom(const std::string& user,
+                                          const Source& source,
+                                          SyncMode sync,
+                                          std::atomic<uint64_t>* progress) {
+  StreamInput input{&source,
+                    std::vector<char>(Config::REQUEST_BUFFER_SIZE), 0};
+
+  return extractArchive(
+      user,
+      [&input](archive* a) {
+        return archive_read_open(a, &input, nullptr, streamReadCallback,
+                                 nullptr);
+      },
+      sync, progress);
+}
 
-    if (ec) {
-      throw std::runtime_error("Failed to create backup: " + ec.message());
+// History snapshot id: 보관한 시각 (epoch ms)
+static bool isHistoryId(const std::string& id) {
+  return !id.empty() && id.size() <= 20 &&
+         id.find_first_not_of("0123456789") == std::string::npos;
+}
+
+// .history 또는 그 아래 snapshot(id)을 symlink를 따라가지 않고 열기
+// (user가 소유한 경로이므로 실제 directory만 허용, 없으면 -1)
+static int openHistory(const std::string& base, const std::string& id = "") {
+  const int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+  int history = open((base + Config::PATH_HISTORY).c_str(), flags);
+  if (history < 0 || id.empty()) {
+    return history;
+  }
+  int fd = openat(history, id.c_str(), flags);
+  close(history);
+  return fd;
+}
+
+// .history 아래 snapshot id 목록 (최신순, directory가 아닌 entry 제외)
+static std::vector<std::string> historyIds(int history) {
+  std::vector<std::string> ids;
+  int fd = openat(history, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  DIR* dir = fd >= 0 ? fdopendir(fd) : nullptr;
+  if (!dir) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    return ids;
+  }
+  while (dirent* d = readdir(dir)) {
+    struct stat st;
+    if (isHistoryId(d->d_name) &&
+        fstatat(history, d->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+        S_ISDIR(st.st_mode)) {
+      ids.push_back(d->d_name);
+    }
+  }
+  closedir(dir);
+  std::sort(ids.begin(), ids.end(),
+            [](const std::string& a, const std::string& b) {
+              // 숫자 변환 없이 비교 (user가 만든 긴 id도 overflow 없음)
+              if (a.size() != b.size()) {
+                return a.size() > b.size();
+              }
+              return a > b;
+            });
+  return ids;
+}
+
+// History snapshot 목록 (최신순)과 크기 (모든 snapshot을 walk)
+static std::vector<HistorySnapshot> scanHistory(int history) {
+  std::vector<HistorySnapshot> snapshots;
+  for (const std::string& id : historyIds(history)) {
+    snapshots.push_back({id, 0, 0, 0});
+  }
+
+  const int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+  auto it = snapshots.begin();
+  while (it != snapshots.end()) {
+    HistorySnapshot& snapshot = *it;
+    int fd = openat(history, snapshot.id.c_str(), flags);
+    if (fd < 0) {
+      it = snapshots.erase(it);
+      continue;
+    }
+    try {
+      utils::scanTree(fd, Config::SCAN_THREADS,
+                      [&](const utils::ScanEntry& entry) {
+                        if (S_ISREG(entry.st.st_mode)) {
+                          ++snapshot.files;
+                          snapshot.bytes +=
+                              static_cast<uint64_t>(entry.st.st_size);
+                        }
+                        snapshot.disk +=
+                            static_cast<uint64_t>(entry.st.st_blocks) * 512;
+                      });
+    } catch (...) {
+      close(fd);
+      throw;
+    }
+    close(fd);
+    ++it;
+  }
+  return snapshots;
+}
+
+// Snapshot 옆의 크기 파일 ("<id>.size": "<files> <bytes> <disk>")
+// 목록 조회는 tree를 walk하지 않고 이 값만 읽음
+static std::string sizeName(const std::string& id) {
+  return id + Config::HISTORY_SIZE_SUFFIX;
+}
+
+static void saveSize(int history, const HistorySnapshot& snapshot) {
+  std::string name = sizeName(snapshot.id);
+  std::string tmp = name + ".tmp";
+  std::string data = std::to_string(snapshot.files) + " " +
+                     std::to_string(snapshot.bytes) + " " +
+                     std::to_string(snapshot.disk) + "\n";
+
+  int fd = openat(history, tmp.c_str(),
+                  O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    PLOGW << "Failed to save snapshot size " << snapshot.id << ": "
+          << strerror(errno);
+    return;
+  }
+  try {
+    writeAll(fd, data.data(), data.size());
+  } catch (const std::exception& e) {
+    PLOGW << "Failed to save snapshot size " << snapshot.id << ": "
+          << e.what();
+    close(fd);
+    unlinkat(history, tmp.c_str(), 0);
+    return;
+  }
+  close(fd);
+  renameat(history, tmp.c_str(), history, name.c_str());
+}
+
+// 저장된 크기 (없거나 형식이 다르면 false, 값은 0)
+static bool loadSize(int history, HistorySnapshot& snapshot) {
+  int fd = openat(history, sizeName(snapshot.id).c_str(),
+                  O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  char buf[128];
+  ssize_t n = read(fd, buf, sizeof(buf) - 1);
+  close(fd);
+  if (n <= 0) {
+    return false;
+  }
+  buf[n] = '\0';
+
+  unsigned long long values[3];
+  if (sscanf(buf, "%llu %llu %llu", &values[0], &values[1], &values[2]) != 3) {
+    return false;
+  }
+  snapshot.files = values[0];
+  snapshot.bytes = values[1];
+  snapshot.disk = values[2];
+  return true;
+}
+
+// MAX_HISTORY_SNAPSHOTS, HISTORY_DISK_BUDGET을 넘는 오래된 snapshot 삭제 후
+// 남은 snapshot의 크기 저장
+static void pruneHistory(const std::string& base) {
+  int history = openHistory(base);
+  if (history < 0) {
+    return;
+  }
+  std::vector<HistorySnapshot> snapshots;
+  try {
+    snapshots = scanHistory(history);
+  } catch (...) {
+    close(history);
+    throw;
+  }
+  uint64_t total = 0;
+  for (const HistorySnapshot& snapshot : snapshots) {
+    total += snapshot.disk;
+  }
+
+  while (!snapshots.empty() &&
+         (snapshots.size() > Config::MAX_HISTORY_SNAPSHOTS ||
+          total > Config::HISTORY_DISK_BUDGET)) {
+    const HistorySnapshot& oldest = snapshots.back();
+    // 목록에서 바로 빠지도록 staging 이름으로 옮긴 뒤 삭제
+    std::string trash = base + Config::PATH_STAGING + "_history_" + oldest.id;
+    if (renameat(history, oldest.id.c_str(), AT_FDCWD, trash.c_str()) == 0) {
+      removeInBackground(trash);
+    } else {
+      PLOGW << "Failed to remove snapshot " << oldest.id << ": "
+            << strerror(errno);
+    }
+    unlinkat(history, sizeName(oldest.id).c_str(), 0);
+    total -= oldest.disk;
+    snapshots.pop_back();
+  }
+
+  for (const HistorySnapshot& snapshot : snapshots) {
+    saveSize(history, snapshot);
+  }
+  close(history);
+}
+
+// User별 history 정리 상태
+// Prune(snapshot 전체 stat)은 요청 thread 밖에서 실행하고, snapshot을 읽는
+// 복원과는 mutex로 직렬화 (목록 조회는 저장된 크기만 읽으므로 lock 없음)
+struct HistoryState {
+  std::mutex mutex;
+  bool running = false;  // historyStatesMutex로 보호
+  bool again = false;
+};
+
+static std::mutex historyStatesMutex;
+static std::unordered_map<std::string, std::unique_ptr<HistoryState>>
+    historyStates;
+
+static HistoryState& historyState(const std::string& base) {
+  std::lock_guard<std::mutex> lock(historyStatesMutex);
+  auto& state = historyStates[base];
+  if (!state) {
+    state = std::make_unique<HistoryState>();
+  }
+  return *state;
+}
+
+// pruneHistory를 background에서 실행 (진행 중이면 끝난 뒤 한 번 더)
+static void pruneInBackground(const std::string& base) {
+  HistoryState& state = historyState(base);
+  {
+    std::lock_guard<std::mutex> lock(historyStatesMutex);
+    if (state.running) {
+      state.again = true;
+      return;
     }
+    state.running = true;
+  }
 
-    backup_created = true;
+  std::thread([base, &state]() {
+    while (true) {
+      try {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        pruneHistory(base);
+      } catch (const std::exception& e) {
+        PLOGW << "Failed to prune history: " << e.what();
+      }
 
-    // rename 성공 후에도 workspace가 남아있는 경우 제거
-    if (fs::exists(workspace)) {
-      fs::remove_all(workspace, ec);
-      if (ec) {
-        throw std::runtime_error("Failed to remove workspace after backup: " +
-                                 ec.message());
+      std::lock_guard<std::mutex> lock(historyStatesMutex);
+      if (!state.again) {
+        state.running = false;
+        return;
       }
+      state.again = false;
     }
+  }).detach();
+}
+
+// 교체되어 staging에 남은 이전 workspace를 history로 보관
+// (workspace는 이미 교체되었으므로 실패해도 예외 없이 log만 남김)
+static void retainWorkspace(const std::string& base, const std::string& old) {
+  if (access(old.c_str(), F_OK) != 0 || Config::MAX_HISTORY_SNAPSHOTS == 0) {
+    return;
+  }
 
-    // 백업 검증
-    if (!fs::exists(backup_path)) {
-      throw std::runtime_error("Backup verification failed: backup not found");
+  std::string history = base + Config::PATH_HISTORY;
+  auto now = std::chrono::system_clock::now();
+  std::string id = std::to_string(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          now.time_since_epoch())
+          .count());
+  if (mkdir(history.c_str(), 0700) != 0 && errno != EEXIST) {
+    PLOGW << "Failed to retain workspace: " << strerror(errno);
+    return;
+  }
+  int dir = openHistory(base);
+  if (dir < 0 || renameat(AT_FDCWD, old.c_str(), dir, id.c_str()) != 0) {
+    PLOGW << "Failed to retain workspace: " << strerror(errno);
+    if (dir >= 0) {
+      close(dir);
     }
+    return;
   }
+  close(dir);
+
+  pruneInBackground(base);
+}
+
+// 이전 실행의 staging을 정리하고 새 staging directory 생성
+static std::string createStaging(const std::string& base) {
+  removeStaleStaging(base);
+
+  auto now = std::chrono::system_clock::now();
+  auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       now.time_since_epoch())
+                       .count();
+  std::string staging =
+      base + Config::PATH_STAGING + "_" + std::to_string(timestamp);
+
+  if (mkdir(staging.c_str(), 0700) != 0) {
+    throw std::runtime_error("Failed to create staging directory: " +
+                             std::string(strerror(errno)));
+  }
+  return staging;
+}
+
+// Sync extract에서 이전 workspace의 file을 symlink를 따라가지 않고 열기
+// Entry는 directory 단위로 이어서 나오므로 마지막 상위 directory fd 재사용
+class PreviousTree {
+ public:
+  explicit PreviousTree(const std::string& root)
+      : rootFd(::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)) {}
+  ~PreviousTree() {
+    closeFile();
+    if (dirFd >= 0) {
+      close(dirFd);
+    }
+    if (rootFd >= 0) {
+      close(rootFd);
+    }
+  }
+
+  PreviousTree(const PreviousTree&) = delete;
+  PreviousTree& operator=(const PreviousTree&) = delete;
+
+  // path: workspace 기준 상대 경로 ("a/b.txt")
+  // regular file이면 읽기 전용 fd (다음 open/closeFile까지 유효), 아니면 -1
+  int open(const std::string& path, struct stat& st) {
+    closeFile();
+    size_t slash = path.rfind('/');
+    std::string parent;
+    std::string name = path;
+    if (slash != std::string::npos) {
+      parent = path.substr(0, slash);
+      name = path.substr(slash + 1);
+    }
+    int dir = openDir(parent);
+    if (dir < 0 || name.empty() || name == "." || name == ".." ||
+        fstatat(dir, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0 ||
+        !S_ISREG(st.st_mode)) {
+      return -1;
+    }
+    int fd = openat(dir, name.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    struct stat opened;
+    if (fd >= 0 && (fstat(fd, &opened) != 0 || opened.st_ino != st.st_ino ||
+                    opened.st_dev != st.st_dev)) {
+      close(fd);
+      return -1;
+    }
+    fileFd = fd;
+    return fd;
+  }
+
+  void closeFile() {
+    if (fileFd >= 0) {
+      close(fileFd);
+      fileFd = -1;
+    }
+  }
+
+ private:
+  int openDir(const std::string& parent) {
+    if (dirFd >= 0 && parent == dirPath) {
+      return dirFd;
+    }
+    if (dirFd >= 0) {
+      close(dirFd);
+    }
+    dirPath = parent;
+    dirFd = rootFd >= 0 ? fcntl(rootFd, F_DUPFD_CLOEXEC, 0) : -1;
+
+    size_t start = 0;
+    while (dirFd >= 0 && start < parent.size()) {
+      size_t end = parent.find('/', start);
+      if (end == std::string::npos) {
+        end = parent.size();
+      }
+      std::string part = parent.substr(start, end - start);
+      start = end + 1;
+      if (part.empty() || part == ".") {
+        continue;
+      }
+      int next = part == ".." ? -1
+                              : openat(dirFd, part.c_str(),
+                                       O_RDONLY | O_DIRECTORY | O_NOFOLLOW |
+                                           O_CLOEXEC);
+      close(dirFd);
+      dirFd = next;
+    }
+    return dirFd;
+  }
+
+  int rootFd;
+  int dirFd = -1;
+  int fileFd = -1;
+  std::string dirPath;
+};
+
+// Data를 읽기 전에 비교할 수 있는 항목 (크기, mode, Metadata면 mtime)
+static bool sameMetadata(const struct stat& st, archive_entry* entry,
+                         SyncMode sync) {
+  if (!archive_entry_size_is_set(entry) ||
+      st.st_size != archive_entry_size(entry) ||
+      (st.st_mode & 01777) != (archive_entry_mode(entry) & 01777)) {
+    return false;
+  }
+  if (sync == SyncMode::Content) {
+    return true;
+  }
+  return archive_entry_mtime_is_set(entry) &&
+         st.st_mtim.tv_sec == archive_entry_mtime(entry) &&
+         st.st_mtim.tv_nsec == archive_entry_mtime_nsec(entry);
+}
+
+// 이전 file의 [0, len)을 writer로 복사 (비교 중 일치한 앞부분)
+static void copyPrevious(utils::TreeWriter& writer, int fd, int64_t len) {
+  std::vector<char> buffer(Config::EXTRACT_CHUNK_SIZE);
+  int64_t offset = 0;
+  while (offset < len) {
+    size_t want = static_cast<size_t>(
+        std::min<int64_t>(len - offset, static_cast<int64_t>(buffer.size())));
+    ssize_t n = pread(fd, buffer.data(), want, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      throw std::runtime_error("Failed to read previous file: " +
+                               std::string(n < 0 ? strerror(errno) : "EOF"));
+    }
+    writer.write(buffer.data(), static_cast<size_t>(n), offset);
+    offset += n;
+  }
+}
+
+// buf가 이전 file의 [offset, offset + size)와 같은지
+static bool samePrevious(int fd, const void* buf, size_t size, int64_t offset,
+                         std::vector<char>& scratch) {
+  scratch.resize(size);
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = pread(fd, scratch.data() + done, size - done,
+                      offset + static_cast<int64_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return memcmp(scratch.data(), buf, size) == 0;
+}
+
+std::string WorkspaceService::extractArchive(
+    const std::string& user, const std::function<int(archive*)>& open,
+    SyncMode sync, std::atomic<uint64_t>* progress) {
+  std::string base = Config::PATH_HOME_BASE + user;
+  std::string workspace = base + Config::PATH_WORKSPACE;
+
+  // 같은 filesystem의 staging directory에 해제한 뒤 workspace와 교체
+  // 실패 시 staging만 버리면 되므로 기존 workspace는 그대로 유지
+  std::string staging = createStaging(base);
+  std::string staged_workspace = staging + Config::PATH_WORKSPACE;
+  std::string message = "Extracted successfully";
+  // 이전 workspace와 hardlink로 공유하는 file 수 (sync, incremental)
+  uint64_t linked = 0;
 
   archive* a = archive_read_new();
   if (!a) {
-    if (backup_created) {
-      std::error_code ec;
-      fs::rename(backup_path, workspace, ec);
-    }
+    removeInBackground(staging);
     throw std::runtime_error("Failed to create archive reader");
   }
 
@@ -206,8 +1680,7 @@ std::string WorkspaceService::extract(const std::string& user) {
     archive_read_support_filter_all(a);
     archive_read_support_format_all(a);
 
-    if (archive_read_open_filename(a, input.c_str(),
-                                   Config::ARCHIVE_BLOCK_SIZE) != ARCHIVE_OK) {
+    if (open(a) != ARCHIVE_OK) {
       throw std::runtime_error("Failed to open archive: " +
                                std::string(archive_error_string(a)));
     }
@@ -215,6 +1688,23 @@ std::string WorkspaceService::extract(const std::string& user) {
     archive_entry* entry;
     size_t total_extracted = 0;
 
+    // 이 thread는 해제만 하고 file 생성/쓰기는 writer thread가 처리
+    utils::TreeWriter writer(staging, Config::EXTRACT_THREADS);
+
+    // Incremental archive: 첫 entry가 DELTA_HEADER
+    bool first = true;
+    bool delta = false;
+    std::vector<std::string> deleted;
+
+    // Sync: "workspace/..." file을 이전 workspace의 같은 경로와 비교
+    std::unique_ptr<PreviousTree> previous;
+    if (sync != SyncMode::Off) {
+      previous = std::make_unique<PreviousTree>(workspace);
+    }
+    const std::string prefix =
+        staged_workspace.substr(staging.size() + 1) + "/";
+    std::vector<char> scratch;
+
     // Entry 순회
     while (true) {
       int r = archive_read_next_header(a, &entry);
@@ -238,46 +1728,145 @@ std::string WorkspaceService::extract(const std::string& user) {
       }
 
       std::string pathname_str(pathname);
+      bool was_first = first;
+      first = false;
+
+      if (pathname_str == Config::DELTA_HEADER) {
+        if (!was_first) {
+          throw std::runtime_error("Invalid delta archive");
+        }
+        std::string id, layout;
+        deltaBase(readMember(a, Config::MAX_DELTA_HEADER_SIZE), id, layout);
+        int current = ::open(workspace.c_str(),
+                             O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (current < 0) {
+          throw std::runtime_error("Workspace directory does not exist");
+        }
+        try {
+          // 다른 snapshot 위에 적용하면 변경/삭제 목록이 맞지 않음
+          if (!matchesBase(base, current, id, layout)) {
+            throw std::invalid_argument(
+                "Workspace does not match delta base snapshot " + id);
+          }
+          linked += cloneTree(current, staged_workspace);
+        } catch (...) {
+          close(current);
+          throw;
+        }
+        close(current);
+        delta = true;
+        continue;
+      }
 
-      // Path Traversal 수동 검증
+      if (pathname_str == Config::DELTA_DELETED) {
+        if (!delta) {
+          throw std::runtime_error("Invalid delta archive");
+        }
+        std::string data = readMember(a, Config::MAX_EXTRACT_SIZE);
+        size_t start = 0;
+        while (start < data.size()) {
+          size_t end = data.find('\0', start);
+          if (end == std::string::npos) {
+            end = data.size();
+          }
+          std::string path = data.substr(start, end - start);
+          if (!isSafeRelative(path)) {
+            throw std::runtime_error("Invalid path detected: " + path);
+          }
+          deleted.push_back(std::move(path));
+          start = end + 1;
+        }
+        continue;
+      }
+
+      // Path Traversal 수동 검증 (".." component는 writer에서도 거부)
       if (pathname_str[0] == '/' ||
           pathname_str.find("../") != std::string::npos ||
           pathname_str.find("..\\") != std::string::npos) {
         throw std::runtime_error("Invalid path detected: " + pathname_str);
       }
 
-      // 경로 길이 검증
-      std::string full_path = base + "/" + pathname;
+      // 경로 길이 검증 (workspace 밖의 entry는 staging과 함께 삭제됨)
+      std::string full_path = staging + "/" + pathname;
       if (full_path.length() > 4000) {
         throw std::runtime_error("Path too long: " + pathname_str);
       }
 
-      archive_entry_set_pathname(entry, full_path.c_str());
+      // 이미 있는 entry(incremental의 hardlink 복제본 포함)는 writer가
+      // 삭제 후 새로 생성
+      mode_t mode = archive_entry_mode(entry);
+      const char* hardlink = archive_entry_hardlink(entry);
+      if (hardlink) {
+        std::string target(hardlink);
+        if (target.empty() || target[0] == '/' ||
+            target.find("../") != std::string::npos) {
+          throw std::runtime_error("Invalid path detected: " + target);
+        }
+        writer.hardlink(pathname_str, target);
+        continue;
+      }
 
-      archive* ext = archive_write_disk_new();
-      if (!ext) {
-        throw std::runtime_error("Failed to create disk writer");
+      switch (archive_entry_filetype(entry)) {
+        case AE_IFDIR:
+          writer.directory(pathname_str, mode);
+          continue;
+        case AE_IFLNK: {
+          const char* target = archive_entry_symlink(entry);
+          writer.symlink(pathname_str, target ? target : "");
+          continue;
+        }
+        case AE_IFREG:
+          break;
+        default:
+          writer.special(pathname_str, mode, archive_entry_rdev(entry));
+          continue;
       }
 
-      archive_write_disk_set_options(
-          ext,
-          // ARCHIVE_EXTRACT_TIME | // 원본 timestamp 복원
-          ARCHIVE_EXTRACT_PERM |               // 원본 권한 복원
-              ARCHIVE_EXTRACT_SECURE_NODOTDOT  // ../ 방지
+      // 이전 file과 비교할 수 있으면 data를 쓰기 전에 보류
+      int previous_fd = -1;
+      if (previous && pathname_str.compare(0, prefix.size(), prefix) == 0) {
+        struct stat st;
+        previous_fd = previous->open(pathname_str.substr(prefix.size()), st);
+        if (previous_fd >= 0 && !sameMetadata(st, entry, sync)) {
+          previous->closeFile();
+          previous_fd = -1;
+        }
+      }
 
-      );
+      if (previous_fd >= 0 && sync == SyncMode::Metadata) {
+        bool adopted = writer.adopt(pathname_str, previous_fd);
+        previous->closeFile();
+        previous_fd = -1;
+        if (adopted) {
+          ++linked;
+          continue;
+        }
+      }
 
-      // Header 쓰기
-      r = archive_write_header(ext, entry);
-      if (r != ARCHIVE_OK) {
-        std::string error_msg = "Failed to write header for " + pathname_str +
-                                ": " + std::string(archive_error_string(ext));
-        archive_write_close(ext);
-        archive_write_free(ext);
-        throw std::runtime_error(error_msg);
+      // Sync로 기록한 file은 다음 비교를 위해 mtime 유지
+      timespec mtime = {0, UTIME_OMIT};
+      if (sync != SyncMode::Off && archive_entry_mtime_is_set(entry)) {
+        mtime.tv_sec = archive_entry_mtime(entry);
+        mtime.tv_nsec = archive_entry_mtime_nsec(entry);
+      }
+      const uint64_t entry_size =
+          static_cast<uint64_t>(archive_entry_size(entry));
+      const bool sparse = archive_entry_sparse_count(entry) > 0;
+
+      // 비교 중(compared: 일치한 앞부분)이 아니면 바로 data 쓰기
+      int64_t compared = 0;
+      if (previous_fd < 0) {
+        writer.beginFile(pathname_str, mode, entry_size, mtime, sparse);
       }
 
-      // Data 쓰기
+      // 다른 부분을 만나면 일치한 앞부분을 이전 file에서 복사하고 전환
+      auto diverge = [&]() {
+        writer.beginFile(pathname_str, mode, entry_size, mtime, sparse);
+        copyPrevious(writer, previous_fd, compared);
+        previous->closeFile();
+        previous_fd = -1;
+      };
+
       const void* buf;
       size_t size;
       int64_t offset;
@@ -294,99 +1883,169 @@ std::string WorkspaceService::extract(const std::string& user) {
         }
 
         if (r != ARCHIVE_OK) {
-          std::string error_msg = "Failed to read data block for " +
-                                  pathname_str + ": " +
-                                  std::string(archive_error_string(a));
-          archive_write_close(ext);
-          archive_write_free(ext);
-          throw std::runtime_error(error_msg);
+          throw std::runtime_error("Failed to read data block for " +
+                                   pathname_str + ": " +
+                                   std::string(archive_error_string(a)));
         }
 
         // Zip Bomb 방어: extract size 제한
         total_extracted += size;
         if (total_extracted > Config::MAX_EXTRACT_SIZE) {
-          archive_write_close(ext);
-          archive_write_free(ext);
           throw std::runtime_error("Extracted size exceeds limit");
         }
+        if (progress) {
+          *progress = total_extracted;
+        }
 
-        r = archive_write_data_block(ext, buf, size, offset);
-        if (r != ARCHIVE_OK) {
-          std::string error_msg = "Failed to write data block for " +
-                                  pathname_str + ": " +
-                                  std::string(archive_error_string(ext));
-          archive_write_close(ext);
-          archive_write_free(ext);
-          throw std::runtime_error(error_msg);
+        if (previous_fd >= 0) {
+          // Sparse 구간은 비교하지 않고 다시 기록
+          if (offset == compared &&
+              samePrevious(previous_fd, buf, size, offset, scratch)) {
+            compared += static_cast<int64_t>(size);
+            continue;
+          }
+          diverge();
         }
-      }
 
-      // Entry 완료 처리
-      r = archive_write_finish_entry(ext);
-      if (r != ARCHIVE_OK) {
-        std::string error_msg = "Failed to finish entry for " + pathname_str +
-                                ": " + std::string(archive_error_string(ext));
-        archive_write_close(ext);
-        archive_write_free(ext);
-        throw std::runtime_error(error_msg);
+        writer.write(buf, size, offset);
       }
 
-      archive_write_close(ext);
-      archive_write_free(ext);
+      if (previous_fd >= 0) {
+        if (compared == static_cast<int64_t>(entry_size) &&
+            writer.adopt(pathname_str, previous_fd)) {
+          previous->closeFile();
+          ++linked;
+          continue;
+        }
+        diverge();
+      }
+      writer.endFile();
     }
 
     archive_read_close(a);
     archive_read_free(a);
     a = nullptr;
 
-    fs::remove(input);
+    for (const std::string& path : deleted) {
+      writer.remove(staged_workspace.substr(staging.size() + 1) + "/" + path);
+    }
+    writer.finish();
 
     // Workspace 검증
-    if (!fs::exists(workspace) || !fs::is_directory(workspace)) {
+    if (!fs::is_directory(staged_workspace)) {
       throw std::runtime_error("Workspace folder not created after extraction");
     }
 
-    // 백업 삭제 (백업이 있을 경우)
-    if (backup_created) {
-      std::error_code ec;
-      fs::remove_all(backup_path, ec);
-      if (ec) {
-        throw std::runtime_error(
-            "Extraction successful but failed to remove backup: " +
-            ec.message());
-      }
-    }
-
-    return "Extracted successfully";
+    // O(1) 교체: 이전 workspace는 staging 안으로 이동
+    swapDirectories(staged_workspace, workspace);
+    ChangeTracker::reset(user);
 
-  } catch (const std::exception& e) {
+    if (sync != SyncMode::Off) {
+      message += " (" + std::to_string(linked) + " unchanged files linked)";
+    }
+  } catch (...) {
     if (a) {
       archive_read_free(a);
     }
+    removeInBackground(staging);
+    throw;
+  }
 
-    // 백업 복원 (백업이 있을 경우)
-    if (backup_created) {
-      std::error_code ec;
+  // 이전 workspace는 history로 보관, 나머지 삭제는 background에서 진행
+  // 새 workspace와 hardlink로 file을 공유하면 보관하지 않음
+  // (workspace에서 제자리 수정하면 snapshot도 바뀌므로)
+  if (linked == 0) {
+    retainWorkspace(base, staged_workspace);
+  } else if (Config::MAX_HISTORY_SNAPSHOTS > 0) {
+    message += " (previous workspace not kept in history: files are shared)";
+  }
+  removeInBackground(staging);
+  return message;
+}
 
-      // 불완전한 workspace 제거
-      if (fs::exists(workspace)) {
-        fs::remove_all(workspace, ec);
-      }
+std::string WorkspaceService::store(const std::string& user,
+                                   std::atomic<uint64_t>* progress) {
+  return "Stored: " + ChunkStore::save(user, progress);
+}
 
-      // 백업 복원
-      fs::rename(backup_path, workspace, ec);
-      if (ec) {
-        throw std::runtime_error(
-            std::string("Extraction failed: ") + e.what() +
-            ". Backup restore also failed: " + ec.message());
-      }
+std::string WorkspaceService::restoreStored(const std::string& user,
+                                           const std::string& id,
+                                           std::atomic<uint64_t>* progress) {
+  std::string base = Config::PATH_HOME_BASE + user;
+  std::string workspace = base + Config::PATH_WORKSPACE;
 
-      throw std::runtime_error(std::string("Extraction failed: ") + e.what() +
-                               ". Restored from backup");
-    }
+  // extract와 같이 staging에 복원한 뒤 workspace와 교체
+  std::string staging = createStaging(base);
+  try {
+    ChunkStore::restore(user, id, staging + Config::PATH_WORKSPACE, progress);
+    swapDirectories(staging + Config::PATH_WORKSPACE, workspace);
+    ChangeTracker::reset(user);
+  } catch (...) {
+    removeInBackground(staging);
+    throw;
+  }
 
+  retainWorkspace(base, staging + Config::PATH_WORKSPACE);
+  removeInBackground(staging);
+  return "Restored: " + id;
+}
+
+std::vector<HistorySnapshot> WorkspaceService::listHistory(
+    const std::string& user) {
+  std::string base = Config::PATH_HOME_BASE + user;
+  std::vector<HistorySnapshot> snapshots;
+  int history = openHistory(base);
+  if (history < 0) {
+    return snapshots;
+  }
+  // 크기는 보관/정리 때 저장한 값 (아직 계산 전이면 0)
+  for (const std::string& id : historyIds(history)) {
+    HistorySnapshot snapshot{id, 0, 0, 0};
+    loadSize(history, snapshot);
+    snapshots.push_back(std::move(snapshot));
+  }
+  close(history);
+  return snapshots;
+}
+
+std::string WorkspaceService::restore(const std::string& user,
+                                      const std::string& id,
+                                      std::atomic<uint64_t>* progress) {
+  if (!isHistoryId(id)) {
+    throw std::invalid_argument("Invalid snapshot id");
+  }
+
+  std::string base = Config::PATH_HOME_BASE + user;
+  std::string workspace = base + Config::PATH_WORKSPACE;
+  // 복제하는 동안 background prune이 snapshot을 삭제하지 않도록 대기
+  std::unique_lock<std::mutex> history_lock(historyState(base).mutex);
+  int snapshot = openHistory(base, id);
+  if (snapshot < 0) {
+    throw std::runtime_error("Snapshot not found");
+  }
+
+  // Snapshot은 그대로 두고 복제본을 staging에 만든 뒤 교체
+  std::string staging;
+  std::string staged_workspace;
+  try {
+    staging = createStaging(base);
+    staged_workspace = staging + Config::PATH_WORKSPACE;
+    cloneTree(snapshot, staged_workspace, true, progress);
+    swapDirectories(staged_workspace, workspace);
+    ChangeTracker::reset(user);
+  } catch (...) {
+    close(snapshot);
+    if (!staging.empty()) {
+      removeInBackground(staging);
+    }
     throw;
   }
+  close(snapshot);
+  history_lock.unlock();
+
+  retainWorkspace(base, staged_workspace);
+  removeInBackground(staging);
+  return "Restored: " + id;
 }
 
 }  // namespace services
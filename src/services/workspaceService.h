@@ -1,13 +1,96 @@
 #pragma once
 
+#include <archive.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <vector>
+
+#include "../codecs/codec.h"
 
 namespace services {
 
+// compress 결과 파일 (fd는 caller가 close)
+struct OutputFile {
+  int fd = -1;
+  std::string filename;
+  codecs::Codec codec = codecs::Codec::Gzip;
+  uint64_t size = 0;
+  int64_t mtime_ns = 0;
+};
+
+// extract/restore로 교체된 이전 workspace (id: 보관 시각, epoch ms)
+// Incremental/sync extract가 바뀌지 않은 file을 hardlink로 가져간 경우
+// 이전 workspace는 보관하지 않음 (workspace에서 제자리 수정하면 snapshot도
+// 바뀌므로), 보관한 snapshot은 다른 tree와 inode를 공유하지 않음
+struct HistorySnapshot {
+  std::string id;
+  uint64_t files = 0;
+  uint64_t bytes = 0;  // file 크기 합
+  uint64_t disk = 0;   // 사용 중인 disk block
+};
+
+// Sync extract: 이전 workspace와 같은 file은 쓰지 않고 hardlink
+//   Metadata: 크기/mode/mtime 비교 (sync로 기록한 file은 mtime 유지)
+//   Content : 크기/mode 비교 후 data를 이전 file과 byte 단위로 비교
+enum class SyncMode { Off, Metadata, Content };
+
 class WorkspaceService {
  public:
-  static std::string compress(const std::string& user);
-  static std::string extract(const std::string& user);
+  // progress: 처리한 byte 수 (job 상태 조회용, nullptr 허용)
+  static std::string compress(const std::string& user,
+                              const codecs::CodecOptions& options,
+                              std::atomic<uint64_t>* progress = nullptr);
+
+  // 파일을 만들지 않고 압축된 byte를 sink로 바로 출력
+  static void stream(const std::string& user,
+                     const codecs::CodecOptions& options,
+                     const codecs::ArchiveOutput::Sink& sink,
+                     std::atomic<uint64_t>* progress = nullptr);
+
+  // 가장 최근 output 파일을 읽기 전용으로 열기 (없으면 false)
+  static bool openOutput(const std::string& user, OutputFile& output);
+
+  static std::string extract(const std::string& user,
+                             SyncMode sync = SyncMode::Off,
+                             std::atomic<uint64_t>* progress = nullptr);
+
+  // 최대 len byte를 buf에 채움 (0: 입력 끝, 오류 시 예외)
+  using Source = std::function<size_t(char* buf, size_t len)>;
+
+  // 파일을 만들지 않고 source에서 읽은 archive를 바로 해제
+  static std::string extractFrom(const std::string& user,
+                                 const Source& source,
+                                 SyncMode sync = SyncMode::Off,
+                                 std::atomic<uint64_t>* progress = nullptr);
+
+  // Workspace를 chunk store에 snapshot으로 저장 ("Stored: <id> ...")
+  static std::string store(const std::string& user,
+                           std::atomic<uint64_t>* progress = nullptr);
+
+  // Chunk store의 snapshot으로 workspace 교체
+  static std::string restoreStored(const std::string& user,
+                                   const std::string& id,
+                                   std::atomic<uint64_t>* progress = nullptr);
+
+  // 보관 중인 history snapshot (최신순)
+  // 크기는 보관/정리 때 background에서 계산해 저장한 값 (tree를 walk하지
+  // 않으며, 아직 계산 전이면 0)
+  static std::vector<HistorySnapshot> listHistory(const std::string& user);
+
+  // History snapshot을 복제해 workspace 교체 (reflink, 미지원 시 복사하므로
+  // 복원한 workspace를 수정해도 snapshot은 바뀌지 않음)
+  static std::string restore(const std::string& user, const std::string& id,
+                             std::atomic<uint64_t>* progress = nullptr);
+
+ private:
+  static std::string extractArchive(const std::string& user,
+                                    const std::function<int(archive*)>& open,
+                                    SyncMode sync,
+                                    std::atomic<uint64_t>* progress);
 };
 
 }  // namespace services
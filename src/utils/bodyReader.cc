@@ -0,0 +1,160 @@
+#include "bodyReader.h"
+
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "config.h"
+#include "utils.h"
+
+namespace utils {
+
+// Chunk size/trailer line 최대 길이
+static constexpr size_t MAX_LINE_SIZE = 4096;
+
+// recv 실패(0 또는 -1) 원인별 예외
+static void throwRecvError(ssize_t n) {
+  if (n == 0) {
+    throw std::runtime_error("Connection closed before body complete");
+  }
+  if (errno == EAGAIN || errno == EWOULDBLOCK) {
+    throw std::runtime_error("Timeout while reading body");
+  }
+  throw std::runtime_error("Failed to read body: " +
+                           std::string(strerror(errno)));
+}
+
+BodyReader::BodyReader(int socket, std::string prefix, bool chunked,
+                       uint64_t content_length)
+    : socket(socket), raw(std::move(prefix)) {
+  if (chunked) {
+    state = State::ChunkSize;
+    remaining = 0;
+  } else {
+    state = content_length > 0 ? State::Length : State::Done;
+    remaining = content_length;
+  }
+}
+
+// Raw buffer가 비어 있으면 socket에서 읽음
+void BodyReader::fill() {
+  if (rawPos < raw.size()) {
+    return;
+  }
+
+  raw.resize(Config::REQUEST_BUFFER_SIZE);
+  rawPos = 0;
+  while (true) {
+    ssize_t n = recv(socket, &raw[0], raw.size(), 0);
+    if (n > 0) {
+      raw.resize(static_cast<size_t>(n));
+      return;
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    raw.clear();
+    throwRecvError(n);
+  }
+}
+
+std::string BodyReader::readLine() {
+  std::string line;
+  while (true) {
+    fill();
+    size_t end = raw.find('\n', rawPos);
+    size_t stop = end == std::string::npos ? raw.size() : end;
+    line.append(raw, rawPos, stop - rawPos);
+
+    if (line.size() > MAX_LINE_SIZE) {
+      throw std::runtime_error("Chunk line too long");
+    }
+    if (end != std::string::npos) {
+      rawPos = end + 1;
+      break;
+    }
+    rawPos = raw.size();
+  }
+
+  if (!line.empty() && line.back() == '\r') {
+    line.pop_back();
+  }
+  return line;
+}
+
+size_t BodyReader::read(char* buf, size_t len) {
+  while (true) {
+    switch (state) {
+      case State::Done:
+        return 0;
+
+      case State::Length:
+      case State::ChunkData: {
+        size_t want = static_cast<size_t>(
+            std::min<uint64_t>(remaining, static_cast<uint64_t>(len)));
+        size_t n;
+
+        if (rawPos < raw.size()) {
+          n = std::min(want, raw.size() - rawPos);
+          memcpy(buf, raw.data() + rawPos, n);
+          rawPos += n;
+        } else {
+          // 남은 buffer가 없으면 caller buffer로 바로 수신
+          ssize_t r = recv(socket, buf, want, 0);
+          if (r < 0 && errno == EINTR) {
+            continue;
+          }
+          if (r <= 0) {
+            throwRecvError(r);
+          }
+          n = static_cast<size_t>(r);
+        }
+
+        remaining -= n;
+        if (remaining == 0) {
+          state = state == State::Length ? State::Done : State::ChunkEnd;
+        }
+        return n;
+      }
+
+      case State::ChunkSize: {
+        std::string line = readLine();
+        if (!parseChunkSize(line.c_str(), line.size(), remaining)) {
+          throw std::runtime_error("Invalid chunk size");
+        }
+        state = remaining == 0 ? State::Trailer : State::ChunkData;
+        break;
+      }
+
+      case State::ChunkEnd:
+        if (!readLine().empty()) {
+          throw std::runtime_error("Invalid chunk terminator");
+        }
+        state = State::ChunkSize;
+        break;
+
+      case State::Trailer:
+        // Trailer header는 무시, 빈 줄에서 종료
+        if (readLine().empty()) {
+          state = State::Done;
+        }
+        break;
+    }
+  }
+}
+
+void BodyReader::drain(uint64_t limit) {
+  char buf[8192];
+  uint64_t total = 0;
+  while (!done()) {
+    total += read(buf, sizeof(buf));
+    if (total > limit) {
+      throw std::runtime_error("Request body too large");
+    }
+  }
+}
+
+}  // namespace utils
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace utils {
+
+// Request body를 socket에서 직접 읽음 (Content-Length 또는 chunked)
+// Reactor가 header와 함께 먼저 읽은 byte(prefix)부터 반환
+class BodyReader {
+ public:
+  BodyReader(int socket, std::string prefix, bool chunked,
+             uint64_t content_length);
+
+  BodyReader(const BodyReader&) = delete;
+  BodyReader& operator=(const BodyReader&) = delete;
+
+  // 최대 len byte를 읽음 (0: body 끝, 오류 시 예외)
+  size_t read(char* buf, size_t len);
+
+  // 남은 body를 읽어서 버림 (응답 전 socket 정리용)
+  void drain(uint64_t limit);
+
+  bool done() const { return state == State::Done; }
+
+  // Body 이후에 이미 수신한 byte (pipelining된 다음 request)
+  std::string leftover() const { return raw.substr(rawPos); }
+
+ private:
+  enum class State { Length, ChunkSize, ChunkData, ChunkEnd, Trailer, Done };
+
+  void fill();
+  std::string readLine();
+
+  int socket;
+  std::string raw;
+  size_t rawPos = 0;
+  State state;
+  uint64_t remaining;
+};
+
+}  // namespace utils
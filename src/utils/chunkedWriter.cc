@@ -0,0 +1,68 @@
+#include "chunkedWriter.h"
+
+#include <cstdio>
+
+#include "config.h"
+#include "httpResponse.h"
+#include "utils.h"
+
+namespace utils {
+
+ChunkedWriter::ChunkedWriter(int socket, const std::string& content_type,
+                             const std::string& filename)
+    : socket(socket), contentType(content_type), filename(filename) {
+  buffer.reserve(Config::CHUNK_BUFFER_SIZE);
+}
+
+void ChunkedWriter::sendHeader() {
+  std::string header =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type: " +
+      contentType +
+      "\r\n"
+      "Content-Disposition: attachment; filename=\"" +
+      filename +
+      "\"\r\n"
+      "Transfer-Encoding: chunked\r\n\r\n";
+  sendAll(socket, header.data(), header.size());
+  headerSent = true;
+}
+
+void ChunkedWriter::write(const char* data, size_t len) {
+  // 첫 byte가 바로 도착하도록 header는 즉시 전송
+  if (!headerSent) {
+    sendHeader();
+  }
+
+  buffer.append(data, len);
+  if (buffer.size() >= Config::CHUNK_BUFFER_SIZE) {
+    flush();
+  }
+}
+
+void ChunkedWriter::flush() {
+  if (buffer.empty()) {
+    return;
+  }
+
+  // Chunk: <size hex>\r\n<data>\r\n (한 번의 sendmsg로 전송)
+  char size_line[32];
+  int n = snprintf(size_line, sizeof(size_line), "%zx\r\n", buffer.size());
+  iovec iov[3] = {
+      {size_line, static_cast<size_t>(n)},
+      {buffer.data(), buffer.size()},
+      {const_cast<char*>("\r\n"), 2},
+  };
+  sendAllv(socket, iov, 3);
+  buffer.clear();
+}
+
+void ChunkedWriter::finish() {
+  if (!headerSent) {
+    sendHeader();
+  }
+  flush();
+  sendAll(socket, "0\r\n\r\n", 5);
+}
+
+}  // namespace utils
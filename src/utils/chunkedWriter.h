@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace utils {
+
+// HTTP/1.1 chunked transfer encoding 응답 (200)
+// Header는 첫 data와 함께 전송되므로 그 전에 발생한 오류는 일반 JSON
+// 응답으로 보낼 수 있음
+class ChunkedWriter {
+ public:
+  ChunkedWriter(int socket, const std::string& content_type,
+                const std::string& filename);
+
+  ChunkedWriter(const ChunkedWriter&) = delete;
+  ChunkedWriter& operator=(const ChunkedWriter&) = delete;
+
+  // 작은 write는 CHUNK_BUFFER_SIZE 단위로 모아서 전송
+  void write(const char* data, size_t len);
+
+  // 남은 data와 마지막 chunk 전송
+  // 호출하지 않으면 client는 불완전한 응답으로 인식
+  void finish();
+
+  bool started() const { return headerSent; }
+
+ private:
+  void sendHeader();
+  void flush();
+
+  int socket;
+  std::string contentType;
+  std::string filename;
+  std::string buffer;
+  bool headerSent = false;
+};
+
+}  // namespace utils
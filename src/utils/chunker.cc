@@ -0,0 +1,62 @@
+#include "chunker.h"
+
+#include <array>
+
+#include "config.h"
+
+namespace utils {
+
+// Byte별 gear 값 (splitmix64, 고정 seed이므로 실행마다 같은 경계)
+static const std::array<uint64_t, 256>& gearTable() {
+  static const std::array<uint64_t, 256> table = []() {
+    std::array<uint64_t, 256> t;
+    uint64_t x = 0x9e3779b97f4a7c15ULL;
+    for (auto& value : t) {
+      x += 0x9e3779b97f4a7c15ULL;
+      uint64_t z = x;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      value = z ^ (z >> 31);
+    }
+    return t;
+  }();
+  return table;
+}
+
+Chunker::Chunker(Emit emit) : emit(std::move(emit)) {
+  current.reserve(Config::CHUNK_MAX_SIZE);
+}
+
+void Chunker::write(const char* data, size_t len) {
+  const auto& gear = gearTable();
+  // 상위 bit 사용 (하위 bit는 최근 몇 byte에만 의존)
+  const uint64_t mask = ~0ULL << (64 - Config::CHUNK_AVG_BITS);
+
+  size_t start = 0;
+  for (size_t i = 0; i < len; ++i) {
+    hash = (hash << 1) + gear[static_cast<uint8_t>(data[i])];
+
+    size_t size = current.size() + (i - start + 1);
+    if ((size >= Config::CHUNK_MIN_SIZE && (hash & mask) == 0) ||
+        size >= Config::CHUNK_MAX_SIZE) {
+      current.append(data + start, i - start + 1);
+      start = i + 1;
+      emit(std::move(current));
+      current = std::string();
+      current.reserve(Config::CHUNK_MAX_SIZE);
+      hash = 0;
+    }
+  }
+  current.append(data + start, len - start);
+}
+
+void Chunker::finish() {
+  if (!current.empty()) {
+    emit(std::move(current));
+    current = std::string();
+    current.reserve(Config::CHUNK_MAX_SIZE);
+  }
+  hash = 0;
+}
+
+}  // namespace utils
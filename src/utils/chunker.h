@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace utils {
+
+// Content-defined chunking (gear rolling hash)
+// 경계가 내용으로 정해지므로 앞부분에 byte가 삽입/삭제되어도 이후 chunk는
+// 그대로 유지됨 (CHUNK_MIN_SIZE ~ CHUNK_MAX_SIZE, 평균 2^CHUNK_AVG_BITS)
+class Chunker {
+ public:
+  using Emit = std::function<void(std::string chunk)>;
+
+  explicit Chunker(Emit emit);
+
+  void write(const char* data, size_t len);
+
+  // 남은 data를 마지막 chunk로 (다음 file을 위해 상태 초기화)
+  void finish();
+
+ private:
+  Emit emit;
+  std::string current;
+  uint64_t hash = 0;
+};
+
+}  // namespace utils
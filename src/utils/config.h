@@ -7,11 +7,81 @@ namespace Config {
 constexpr int PORT = 8888;
 constexpr int LISTEN_BACKLOG = 10;
 constexpr int HTTP_TIMEOUT_SEC = 30;
+constexpr size_t WORKER_THREADS = 16;
+constexpr size_t MAX_CONNECTIONS = 1024;
+constexpr int EPOLL_MAX_EVENTS = 64;
+constexpr size_t MAX_HEADER_SIZE = 16384;  // 16KB (request line + headers)
+constexpr size_t MAX_HEADER_COUNT = 100;
+
+// Job
+constexpr size_t JOB_THREADS = 4;
+constexpr size_t MAX_JOBS = 1024;
+constexpr int JOB_RETENTION_SEC = 3600;
 
 // Buffer size
 constexpr size_t REQUEST_BUFFER_SIZE = 65536;   // 64KB
-constexpr size_t FILE_BUFFER_SIZE = 8192;       // 8KB
-constexpr size_t ARCHIVE_BLOCK_SIZE = 10240;    // 10KB
+constexpr size_t MAX_REQUEST_SIZE = 1024 * 1024;  // 1MB
+constexpr size_t ARCHIVE_BLOCK_SIZE = 262144;   // 256KB (입력 archive read)
+constexpr size_t GZIP_BLOCK_SIZE = 131072;      // 128KB
+constexpr size_t CHUNK_BUFFER_SIZE = 65536;     // 64KB
+constexpr size_t GETDENTS_BUFFER_SIZE = 262144;  // 256KB
+
+// Compression
+constexpr size_t COMPRESS_THREADS = 0;  // 0: CPU core 수
+constexpr size_t MAX_COMPRESS_THREADS = 64;
+constexpr int GZIP_LEVEL = 6;
+constexpr int ZSTD_LEVEL = 3;
+constexpr int LZ4_LEVEL = 1;
+
+// Directory scan
+constexpr size_t SCAN_THREADS = 8;         // I/O 위주이므로 core 수와 무관
+constexpr size_t MAX_SCAN_AHEAD = 65536;   // visit 전에 보관할 최대 entry 수
+constexpr size_t SCAN_OPEN_DIRS = 256;     // 하위 scan용으로 열어 둘 fd 수
+
+// Member archive (members option)
+constexpr size_t MEMBER_SIZE = 4 * 1024 * 1024;  // segment 최대 tar byte
+constexpr size_t MEMBER_GROUP_SPREAD = 256;  // 작은 entry group 평균 크기
+
+// Compress exclude pattern (.workspaceignore + 요청)
+constexpr size_t MAX_EXCLUDE_PATTERNS = 1024;
+
+// Chunk store (content-defined chunking, 모든 user 공유)
+constexpr size_t CHUNK_MIN_SIZE = 16 * 1024;   // 16KB
+constexpr size_t CHUNK_MAX_SIZE = 256 * 1024;  // 256KB
+constexpr int CHUNK_AVG_BITS = 16;             // 평균 64KB
+constexpr int CHUNK_LEVEL = 3;                 // zlib
+constexpr size_t MAX_STORED_SNAPSHOTS = 4;     // user별 보관 수
+
+// Workspace history (extract/restore로 교체된 workspace 보관)
+constexpr size_t MAX_HISTORY_SNAPSHOTS = 5;  // 0: 보관 안 함
+constexpr uint64_t HISTORY_DISK_BUDGET = 2ULL * 1024 * 1024 * 1024;  // 2GB
+constexpr size_t COPY_CHUNK_SIZE = 16 * 1024 * 1024;  // copy_file_range 단위
+
+// Change tracking (inotify)
+constexpr size_t MAX_DIRTY_PATHS = 10000;  // 초과 시 전체 변경으로 취급
+constexpr int WATCH_RETRY_SEC = 60;  // watch 등록 실패 후 재시도까지 대기
+
+// Batched file I/O (io_uring, 미지원 시 blocking syscall)
+constexpr unsigned IO_URING_DEPTH = 64;          // 한 번에 제출하는 요청 수
+constexpr size_t IO_BATCH_FILES = 32;            // 묶어 처리하는 file 수
+constexpr size_t IO_BATCH_FILE_MAX = 64 * 1024;  // 묶어 처리할 file 최대 크기
+
+// File read-ahead (compress)
+constexpr size_t PREFETCH_THREADS = 4;
+constexpr size_t PREFETCH_CHUNK_SIZE = 1024 * 1024;     // 1MB
+constexpr size_t PREFETCH_MEMORY = 32 * 1024 * 1024;    // 32MB
+constexpr size_t MAX_PREFETCH_FILES = 4096;
+
+// Parallel extract (해제 thread 1개 + file writer thread)
+constexpr size_t EXTRACT_THREADS = 8;  // I/O 위주이므로 core 수와 무관
+constexpr size_t EXTRACT_CHUNK_SIZE = 1024 * 1024;   // 1MB
+constexpr size_t EXTRACT_MEMORY = 64 * 1024 * 1024;  // 64MB
+constexpr size_t EXTRACT_DIR_CACHE = 256;  // 열어 둘 directory fd 수
+// 이 크기 이상인 file은 fallocate로 미리 할당 (작은 file은 delalloc에 맡김)
+constexpr size_t EXTRACT_PREALLOCATE_MIN = 64 * 1024;  // 64KB
+// 이 크기 이상인 file은 O_DIRECT로 기록 (page cache 오염 방지, 0: 사용 안 함)
+constexpr size_t EXTRACT_DIRECT_MIN = 256 * 1024 * 1024;  // 256MB
+constexpr size_t DIRECT_IO_ALIGN = 4096;
 
 // Safety limits
 constexpr int MAX_RECURSION_DEPTH = 100;
@@ -20,8 +90,21 @@ constexpr size_t MAX_ARCHIVE_SIZE = 100 * 1024 * 1024;   // 100MB
 
 // Paths
 constexpr const char* PATH_HOME_BASE = "/home/";
+constexpr const char* PATH_CHUNK_STORE = "/home/.chunkstore";
 constexpr const char* PATH_WORKSPACE = "/workspace";
-constexpr const char* PATH_INPUT = "/input.tgz";
-constexpr const char* PATH_OUTPUT = "/output.tgz";
-constexpr const char* PATH_BACKUP_BASE = "/tmp/workspace_backup";
+constexpr const char* PATH_INPUT = "/input";    // + codec 확장자
+constexpr const char* PATH_OUTPUT = "/output";  // + codec 확장자
+constexpr const char* PATH_IGNORE = "/.workspaceignore";  // 줄마다 pattern
+constexpr const char* PATH_FINGERPRINT = "/.output.fingerprint";
+constexpr const char* PATH_MEMBER_INDEX = "/.output.members";
+constexpr const char* PATH_STAGING = "/.workspace_staging";  // + timestamp
+constexpr const char* PATH_HISTORY = "/.history";  // + "/" + snapshot id
+constexpr const char* HISTORY_SIZE_SUFFIX = ".size";  // snapshot 크기 파일
+constexpr const char* PATH_MANIFESTS = "/.snapshots";  // + "/" + snapshot id
+
+// Incremental archive
+constexpr size_t MAX_MANIFESTS = 8;  // 보관할 snapshot manifest 수
+constexpr const char* DELTA_HEADER = ".workspace-delta";     // 첫 entry
+constexpr const char* DELTA_DELETED = ".workspace-deleted";  // 마지막 entry
+constexpr size_t MAX_DELTA_HEADER_SIZE = 4096;  // "base <id>\n"
 }  // namespace Config
@@ -0,0 +1,381 @@
+#include "dirScanner.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "ioBatch.h"
+
+namespace utils {
+
+namespace {
+
+enum NodeState { Pending, Claimed, Ready };
+
+struct Node;
+
+// 하위 directory를 openat으로 열기 위한 상위 directory fd
+// (마지막 하위 node가 열리면 close)
+struct DirFd {
+  int fd;
+  std::atomic<size_t>& open;
+
+  DirFd(int fd, std::atomic<size_t>& open) : fd(fd), open(open) { ++open; }
+  ~DirFd() {
+    close(fd);
+    --open;
+  }
+};
+
+struct Child {
+  std::string name;
+  struct stat st;
+  std::shared_ptr<Node> dir;  // directory인 경우 하위 node
+};
+
+struct Node {
+  std::string path;  // root 기준 상대 경로 (root: "")
+  std::string name;
+  std::shared_ptr<DirFd> parent;  // 없으면 root부터 경로를 따라 열기
+  int depth = 0;
+  std::atomic<int> state{Pending};
+  std::vector<Child> children;  // 이름순
+  std::string error;
+};
+
+struct Scan {
+  int rootFd = -1;
+  const ScanPrune* prune = nullptr;
+  bool symlinks = false;  // symlink entry도 전달
+  std::atomic<size_t> openDirs{0};  // 보관 중인 DirFd 수
+
+  // Thread별 deque (마지막은 visit하는 thread용)
+  // 자기 deque는 뒤에서(LIFO), 다른 deque는 앞에서(FIFO) 가져옴
+  std::vector<std::deque<std::shared_ptr<Node>>> queues;
+  size_t queued = 0;
+
+  // Scan은 끝났지만 아직 visit하지 않은 entry 수 (worker 선행 제한)
+  size_t buffered = 0;
+  bool stopping = false;
+
+  std::mutex mutex;
+  std::condition_variable workCv;
+  std::condition_variable readyCv;
+};
+
+// Thread별 getdents buffer와 stat 요청 batch
+struct Worker {
+  std::vector<char> buf = std::vector<char>(Config::GETDENTS_BUFFER_SIZE);
+  IoBatch io;
+};
+
+const int DIR_FLAGS = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+
+// 열린 directory fd의 entry를 읽어 node.children에 추가
+// getdents로 읽은 entry의 stat은 IoBatch로 한 번에 요청
+void readEntries(Scan& s, Node& node, Worker& w, int fd) {
+  struct Stat {
+    Child child;
+    std::string path;
+    unsigned char type;
+    int res = 0;
+  };
+  std::vector<Stat> batch;
+
+  while (true) {
+    long n = syscall(SYS_getdents64, fd, w.buf.data(), w.buf.size());
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      node.error = "Cannot read directory";
+      break;
+    }
+    if (n == 0) {
+      break;
+    }
+
+    batch.clear();
+    for (long offset = 0; offset < n;) {
+      auto* d = reinterpret_cast<dirent64*>(w.buf.data() + offset);
+      offset += d->d_reclen;
+
+      const char* name = d->d_name;
+      if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0 ||
+          (d->d_type == DT_LNK && !s.symlinks)) {
+        continue;
+      }
+
+      Stat entry;
+      entry.child.name = name;
+      entry.path = node.path.empty() ? entry.child.name
+                                     : node.path + "/" + entry.child.name;
+      entry.type = d->d_type;
+
+      // 제외할 entry는 stat하지 않음
+      if (s.prune && d->d_type != DT_UNKNOWN &&
+          (*s.prune)(entry.path, d->d_type == DT_DIR)) {
+        continue;
+      }
+      batch.push_back(std::move(entry));
+    }
+
+    // AT_SYMLINK_NOFOLLOW: symlink 따라가지 않음 (d_type 미지원 fs 대비)
+    for (Stat& entry : batch) {
+      w.io.stat(fd, entry.child.name.c_str(), AT_SYMLINK_NOFOLLOW,
+                &entry.child.st, &entry.res);
+    }
+    w.io.run();
+
+    for (Stat& entry : batch) {
+      Child& child = entry.child;
+      if (entry.res != 0 || (S_ISLNK(child.st.st_mode) && !s.symlinks)) {
+        continue;
+      }
+
+      if (s.prune && entry.type == DT_UNKNOWN &&
+          (*s.prune)(entry.path, S_ISDIR(child.st.st_mode))) {
+        continue;
+      }
+
+      if (S_ISDIR(child.st.st_mode)) {
+        child.dir = std::make_shared<Node>();
+        child.dir->path = std::move(entry.path);
+        child.dir->name = child.name;
+        child.dir->depth = node.depth + 1;
+      }
+      node.children.push_back(std::move(child));
+    }
+  }
+}
+
+// Directory 하나를 읽고 child를 stat (오류는 node.error에 기록)
+void readDir(Scan& s, Node& node, Worker& w) {
+  if (node.depth > Config::MAX_RECURSION_DEPTH) {
+    node.error = "Maximum directory depth exceeded";
+    return;
+  }
+
+  // 상위 directory fd 기준으로 이름만 열어 symlink를 따라가지 않음
+  int fd = node.parent ? openat(node.parent->fd, node.name.c_str(), DIR_FLAGS)
+                       : openBeneath(s.rootFd, node.path, DIR_FLAGS);
+  node.parent.reset();
+  if (fd < 0) {
+    node.error = "Cannot open directory";
+    return;
+  }
+
+  try {
+    readEntries(s, node, w, fd);
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+
+  // 하위 directory가 열릴 때까지 fd 보관 (한도를 넘으면 경로로 열기)
+  bool has_dirs = std::any_of(node.children.begin(), node.children.end(),
+                              [](const Child& c) { return c.dir != nullptr; });
+  if (has_dirs && node.error.empty() &&
+      s.openDirs.load() < Config::SCAN_OPEN_DIRS) {
+    auto handle = std::make_shared<DirFd>(fd, s.openDirs);
+    for (Child& child : node.children) {
+      if (child.dir) {
+        child.dir->parent = handle;
+      }
+    }
+  } else {
+    close(fd);
+  }
+
+  std::sort(node.children.begin(), node.children.end(),
+            [](const Child& a, const Child& b) { return a.name < b.name; });
+}
+
+// Node를 선점한 경우에만 scan하고 하위 directory를 queue에 추가
+void claimAndScan(Scan& s, Node& node, size_t queue, Worker& w) {
+  int expected = Pending;
+  if (!node.state.compare_exchange_strong(expected, Claimed)) {
+    return;
+  }
+
+  // 예외(prune 오류, memory 부족 등)도 node.error로 visit하는 thread에 전달
+  try {
+    readDir(s, node, w);
+  } catch (const std::exception& e) {
+    node.error = e.what();
+  } catch (...) {
+    node.error = "Cannot read directory";
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    // 앞 directory가 먼저 꺼내지도록 역순으로 추가
+    for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+      if (it->dir) {
+        s.queues[queue].push_back(it->dir);
+        ++s.queued;
+      }
+    }
+    s.buffered += node.children.size();
+    node.state = Ready;
+  }
+  s.readyCv.notify_all();
+  s.workCv.notify_all();
+}
+
+// 가져올 node가 없으면 nullptr (lock 보유 상태에서 호출)
+std::shared_ptr<Node> takeLocked(Scan& s, size_t self) {
+  std::shared_ptr<Node> node;
+  auto& own = s.queues[self];
+  if (!own.empty()) {
+    node = std::move(own.back());
+    own.pop_back();
+  } else {
+    for (size_t i = 1; i < s.queues.size(); ++i) {
+      auto& victim = s.queues[(self + i) % s.queues.size()];
+      if (!victim.empty()) {
+        node = std::move(victim.front());
+        victim.pop_front();
+        break;
+      }
+    }
+  }
+  if (node) {
+    --s.queued;
+  }
+  return node;
+}
+
+void workerLoop(Scan& s, size_t self) {
+  Worker w;
+
+  while (true) {
+    std::shared_ptr<Node> node;
+    {
+      std::unique_lock<std::mutex> lock(s.mutex);
+      s.workCv.wait(lock, [&s]() {
+        return s.stopping ||
+               (s.queued > 0 && s.buffered < Config::MAX_SCAN_AHEAD);
+      });
+      if (s.stopping) {
+        return;
+      }
+      node = takeLocked(s, self);
+    }
+    if (node) {
+      claimAndScan(s, *node, self, w);
+    }
+  }
+}
+
+void visitNode(Scan& s, Node& node, size_t self, Worker& w,
+               const ScanVisitor& visit) {
+  // Worker가 아직 가져가지 않았으면 직접 scan (thread 수와 무관하게 진행)
+  claimAndScan(s, node, self, w);
+  {
+    std::unique_lock<std::mutex> lock(s.mutex);
+    s.readyCv.wait(lock, [&node]() { return node.state == Ready; });
+  }
+
+  if (!node.error.empty()) {
+    throw std::runtime_error(node.error);
+  }
+
+  ScanEntry entry;
+  for (Child& child : node.children) {
+    entry.path = node.path.empty() ? child.name : node.path + "/" + child.name;
+    entry.st = child.st;
+    visit(entry);
+
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      if (s.buffered-- == Config::MAX_SCAN_AHEAD) {
+        s.workCv.notify_all();
+      }
+    }
+
+    if (child.dir) {
+      visitNode(s, *child.dir, self, w, visit);
+      child.dir.reset();  // 처리한 subtree는 바로 해제
+    }
+  }
+}
+
+}  // namespace
+
+void scanTree(const std::string& root, size_t threads,
+              const ScanVisitor& visit, const ScanPrune& prune,
+              bool symlinks) {
+  int fd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open directory");
+  }
+  try {
+    scanTree(fd, threads, visit, prune, symlinks);
+  } catch (...) {
+    close(fd);
+    throw;
+  }
+  close(fd);
+}
+
+void scanTree(int root, size_t threads, const ScanVisitor& visit,
+              const ScanPrune& prune, bool symlinks) {
+  Scan s;
+  if (prune) {
+    s.prune = &prune;
+  }
+  s.symlinks = symlinks;
+  s.rootFd = fcntl(root, F_DUPFD_CLOEXEC, 0);
+  if (s.rootFd < 0) {
+    throw std::runtime_error("Cannot open directory");
+  }
+
+  if (threads == 0) {
+    threads = 1;
+  }
+  s.queues.resize(threads + 1);
+
+  std::vector<std::thread> workers;
+  auto stop = [&s, &workers]() {
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.stopping = true;
+    }
+    s.workCv.notify_all();
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    close(s.rootFd);
+  };
+
+  try {
+    for (size_t i = 0; i < threads; ++i) {
+      workers.emplace_back(workerLoop, std::ref(s), i);
+    }
+
+    Node root_node;
+    Worker w;
+    visitNode(s, root_node, threads, w, visit);
+  } catch (...) {
+    stop();
+    throw;
+  }
+  stop();
+}
+
+}  // namespace utils
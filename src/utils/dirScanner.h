@@ -0,0 +1,38 @@
+#pragma once
+
+#include <sys/stat.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace utils {
+
+struct ScanEntry {
+  std::string path;  // root 기준 상대 경로 (예: "src/main.cc")
+  struct stat st;
+};
+
+using ScanVisitor = std::function<void(const ScanEntry& entry)>;
+
+// true: entry 제외 (directory면 subtree 전체를 읽지 않음)
+// stat 전에 worker thread에서 호출 (d_type 미지원 fs는 stat 후)
+using ScanPrune = std::function<bool(const std::string& path, bool is_dir)>;
+
+// root 아래 entry를 이름순 pre-order로 visit (root 자체 제외)
+// symlink는 따라가지 않으며 symlinks가 false이면 entry도 전달하지 않음
+// Directory 읽기(getdents64)와 stat은 threads개의 worker가 work stealing
+// deque로 병렬 처리하고, visit은 호출한 thread에서 순서대로 실행
+// (getdents로 읽은 entry의 stat은 IoBatch로 묶어서 요청)
+// 하위 directory는 상위 directory fd 기준 O_NOFOLLOW로 열기
+// (scan 중 symlink로 바뀌어도 따라가지 않음)
+// 아직 scan되지 않은 directory에 도달하면 호출한 thread가 직접 scan
+void scanTree(const std::string& root, size_t threads,
+              const ScanVisitor& visit, const ScanPrune& prune = nullptr,
+              bool symlinks = false);
+
+// 이미 연 directory fd 기준으로 scan (fd는 호출한 쪽이 닫음)
+void scanTree(int root, size_t threads, const ScanVisitor& visit,
+              const ScanPrune& prune = nullptr, bool symlinks = false);
+
+}  // namespace utils
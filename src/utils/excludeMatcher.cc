@@ -0,0 +1,162 @@
+#include "excludeMatcher.h"
+
+#include <fnmatch.h>
+
+namespace utils {
+
+static bool hasGlob(const std::string& str) {
+  return str.find_first_of("*?[\\") != std::string::npos;
+}
+
+static std::vector<std::string> splitPath(const std::string& path) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = path.find('/', start);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    if (end > start) {
+      parts.push_back(path.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return parts;
+}
+
+ExcludeMatcher::ExcludeMatcher(const std::vector<std::string>& patterns) {
+  for (const std::string& pattern : patterns) {
+    add(pattern);
+  }
+}
+
+void ExcludeMatcher::add(std::string pattern) {
+  // 끝의 공백/CR 제거 (Windows에서 만든 파일 대비)
+  while (!pattern.empty() &&
+         (pattern.back() == ' ' || pattern.back() == '\r')) {
+    pattern.pop_back();
+  }
+  if (pattern.empty() || pattern[0] == '#') {
+    return;
+  }
+
+  Rule rule;
+  if (pattern[0] == '!') {
+    rule.negate = true;
+    pattern.erase(0, 1);
+  }
+  if (!pattern.empty() && pattern.back() == '/') {
+    rule.dirOnly = true;
+    pattern.pop_back();
+  }
+
+  // 중간에 '/'가 없으면 이름 pattern, 있으면 root 기준 경로
+  bool rooted = !pattern.empty() && pattern[0] == '/';
+  std::vector<std::string> parts = splitPath(pattern);
+  if (parts.empty()) {
+    return;
+  }
+
+  size_t index = rules.size();
+  rules.push_back(rule);
+
+  if (!rooted && parts.size() == 1) {
+    if (hasGlob(parts[0])) {
+      nameGlobs.emplace_back(parts[0], index);
+    } else {
+      names[parts[0]].push_back(index);
+    }
+    return;
+  }
+
+  Node* node = &root;
+  for (const std::string& part : parts) {
+    if (part == "**") {
+      if (!node->any) {
+        node->any = std::make_unique<Node>();
+      }
+      node = node->any.get();
+    } else if (hasGlob(part)) {
+      node->globs.emplace_back(part, std::make_unique<Node>());
+      node = node->globs.back().second.get();
+    } else {
+      auto& child = node->literal[part];
+      if (!child) {
+        child = std::make_unique<Node>();
+      }
+      node = child.get();
+    }
+  }
+  node->rules.push_back(index);
+  anchored = true;
+}
+
+bool ExcludeMatcher::applies(size_t rule, bool is_dir) const {
+  return is_dir || !rules[rule].dirOnly;
+}
+
+// parts[i..]를 소비하며 끝에 도달한 node의 rule 중 가장 나중 것을 best에 기록
+void ExcludeMatcher::matchPath(const Node& node,
+                               const std::vector<std::string>& parts, size_t i,
+                               bool is_dir, long& best) const {
+  if (i == parts.size()) {
+    for (size_t rule : node.rules) {
+      if (static_cast<long>(rule) > best && applies(rule, is_dir)) {
+        best = static_cast<long>(rule);
+      }
+    }
+    return;
+  }
+
+  auto it = node.literal.find(parts[i]);
+  if (it != node.literal.end()) {
+    matchPath(*it->second, parts, i + 1, is_dir, best);
+  }
+  for (const auto& glob : node.globs) {
+    if (fnmatch(glob.first.c_str(), parts[i].c_str(), 0) == 0) {
+      matchPath(*glob.second, parts, i + 1, is_dir, best);
+    }
+  }
+  // "a/**"는 a 자체와는 일치하지 않도록 component가 남은 경우만
+  if (node.any) {
+    for (size_t k = i; k <= parts.size(); ++k) {
+      matchPath(*node.any, parts, k, is_dir, best);
+    }
+  }
+}
+
+bool ExcludeMatcher::excluded(const std::string& path, bool is_dir) const {
+  if (rules.empty()) {
+    return false;
+  }
+
+  long best = -1;
+  size_t slash = path.rfind('/');
+  std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+  auto it = names.find(name);
+  if (it != names.end()) {
+    for (size_t rule : it->second) {
+      if (static_cast<long>(rule) > best && applies(rule, is_dir)) {
+        best = static_cast<long>(rule);
+      }
+    }
+  }
+  for (auto glob = nameGlobs.rbegin(); glob != nameGlobs.rend(); ++glob) {
+    if (static_cast<long>(glob->second) <= best) {
+      break;
+    }
+    if (applies(glob->second, is_dir) &&
+        fnmatch(glob->first.c_str(), name.c_str(), 0) == 0) {
+      best = static_cast<long>(glob->second);
+      break;
+    }
+  }
+  if (anchored) {
+    matchPath(root, splitPath(path), 0, is_dir, best);
+  }
+
+  return best >= 0 && !rules[static_cast<size_t>(best)].negate;
+}
+
+}  // namespace utils
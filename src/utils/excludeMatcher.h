@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace utils {
+
+// gitignore 형식 exclude pattern
+//   "name", "*.log" : 모든 깊이의 이름과 일치
+//   "a/b", "/a"     : root 기준 경로 ('/' 포함 시 고정, "**" 사용 가능)
+//   "name/"         : directory만
+//   "!pattern"      : 앞선 pattern의 제외 취소 (마지막으로 일치한 pattern 적용)
+//   "#...", 빈 줄   : 무시
+// 제외된 directory는 subtree 전체를 scan하지 않으므로 그 아래 entry를
+// "!"로 다시 포함할 수 없음 (git과 같음)
+//
+// Glob이 없는 이름은 hash table, 고정 경로는 component 단위 trie로 찾고
+// glob component만 fnmatch로 비교 (여러 thread에서 동시에 호출 가능)
+class ExcludeMatcher {
+ public:
+  ExcludeMatcher() = default;
+  explicit ExcludeMatcher(const std::vector<std::string>& patterns);
+
+  bool empty() const { return rules.empty(); }
+
+  // path: root 기준 상대 경로 (예: "src/build")
+  bool excluded(const std::string& path, bool is_dir) const;
+
+ private:
+  struct Rule {
+    bool negate = false;
+    bool dirOnly = false;
+  };
+
+  struct Node {
+    std::unordered_map<std::string, std::unique_ptr<Node>> literal;
+    std::vector<std::pair<std::string, std::unique_ptr<Node>>> globs;
+    std::unique_ptr<Node> any;  // "**": 0개 이상의 component
+    std::vector<size_t> rules;  // 이 node에서 끝나는 rule
+  };
+
+  void add(std::string pattern);
+  bool applies(size_t rule, bool is_dir) const;
+  void matchPath(const Node& node, const std::vector<std::string>& parts,
+                 size_t i, bool is_dir, long& best) const;
+
+  std::vector<Rule> rules;
+  std::unordered_map<std::string, std::vector<size_t>> names;
+  std::vector<std::pair<std::string, size_t>> nameGlobs;  // rule 순
+  Node root;
+  bool anchored = false;  // trie에 rule이 있는지
+};
+
+}  // namespace utils
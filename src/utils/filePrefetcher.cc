@@ -0,0 +1,524 @@
+#include "filePrefetcher.h"
+
+#include <fcntl.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "config.h"
+
+namespace utils {
+
+// 최대 len byte를 읽음 (EOF 시 그 이전까지, 오류는 error에 기록)
+static size_t readFully(int fd, char* buf, size_t len, std::string& error,
+                        const std::string& path) {
+  size_t total = 0;
+  while (total < len) {
+    ssize_t n = ::read(fd, buf + total, len - total);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      error = "Failed to read " + path + ": " + strerror(errno);
+      break;
+    }
+    if (n == 0) {
+      break;
+    }
+    total += static_cast<size_t>(n);
+  }
+  return total;
+}
+
+static constexpr int FILE_FLAGS = O_RDONLY | O_NOFOLLOW | O_CLOEXEC;
+
+// 열 수 없는 file은 data 없이 기록 (scan 이후 삭제된 경우 등)
+// Scan 이후 중간 directory가 symlink로 바뀌어도 root 밖을 열지 않음
+static int openFile(int root, const std::string& path) {
+  int fd = openBeneath(root, path, FILE_FLAGS);
+  if (fd >= 0) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+  return fd;
+}
+
+// 첫 extent의 physical offset (실패 시 false)
+static bool firstExtent(int root, const std::string& path,
+                        uint64_t& physical) {
+  int fd = openBeneath(root, path, FILE_FLAGS);
+  if (fd < 0) {
+    return false;
+  }
+
+  alignas(fiemap) char buf[sizeof(fiemap) + sizeof(fiemap_extent)] = {};
+  auto* map = reinterpret_cast<fiemap*>(buf);
+  map->fm_start = 0;
+  map->fm_length = FIEMAP_MAX_OFFSET;
+  map->fm_extent_count = 1;
+
+  bool ok = ioctl(fd, FS_IOC_FIEMAP, map) == 0;
+  int err = errno;
+  close(fd);
+  if (!ok) {
+    errno = err;
+    return false;
+  }
+
+  // Extent가 없는 file(빈 file, inline data)은 맨 앞으로
+  physical = map->fm_mapped_extents > 0 ? map->fm_extents[0].fe_physical : 0;
+  return true;
+}
+
+FilePrefetcher::FilePrefetcher(const std::string& root, ReadOrder order,
+                               Filter filter, ScanPrune prune,
+                               bool symlinks)
+    : root(root),
+      order(order),
+      filter(std::move(filter)),
+      prune(std::move(prune)),
+      symlinks(symlinks) {
+  start();
+}
+
+FilePrefetcher::FilePrefetcher(const std::string& root,
+                               std::vector<ScanEntry> entries,
+                               ReadOrder order, Filter filter)
+    : root(root),
+      order(order),
+      filter(std::move(filter)),
+      symlinks(false),
+      listed(true),
+      entries(std::move(entries)) {
+  start();
+}
+
+void FilePrefetcher::start() {
+  // 모든 file은 이 fd 기준으로 열기 (실패하면 scan 오류로 전달)
+  rootFd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  scanner = std::thread(&FilePrefetcher::scanLoop, this);
+  for (size_t i = 0; i < Config::PREFETCH_THREADS; ++i) {
+    readers.emplace_back(&FilePrefetcher::readerLoop, this);
+  }
+}
+
+FilePrefetcher::~FilePrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  itemCv.notify_all();
+  workCv.notify_all();
+  budgetCv.notify_all();
+
+  scanner.join();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  if (inlineFd >= 0) {
+    close(inlineFd);
+  }
+  if (rootFd >= 0) {
+    close(rootFd);
+  }
+}
+
+void FilePrefetcher::scanLoop() {
+  try {
+    if (rootFd < 0) {
+      throw std::runtime_error("Cannot open directory");
+    }
+    if (listed) {
+      for (const ScanEntry& entry : entries) {
+        push(entry);
+      }
+    } else {
+      scanTree(rootFd, Config::SCAN_THREADS,
+               [this](const ScanEntry& entry) { push(entry); }, prune,
+               symlinks);
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!stopping) {
+      scanError = std::current_exception();
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    scanDone = true;
+  }
+  itemCv.notify_all();
+  workCv.notify_all();
+}
+
+uint64_t FilePrefetcher::readKey(const ScanEntry& entry, uint64_t seq) {
+  if (order == ReadOrder::Extent && extentSupported) {
+    uint64_t physical;
+    if (firstExtent(rootFd, entry.path, physical)) {
+      return physical;
+    }
+    // FIEMAP 미지원 fs: 이후 file은 inode 순으로
+    if (errno == EOPNOTSUPP || errno == ENOTTY) {
+      extentSupported = false;
+    }
+  }
+  if (order != ReadOrder::Name) {
+    return static_cast<uint64_t>(entry.st.st_ino);
+  }
+  return seq;
+}
+
+void FilePrefetcher::push(const ScanEntry& entry) {
+  auto item = std::make_shared<Item>();
+  item->entry = entry;
+
+  uint64_t seq = pushed++;
+  bool regular = S_ISREG(entry.st.st_mode);
+  if (regular && filter && !filter(entry)) {
+    // 읽지 않는 file은 이미 다 읽은 것으로 처리
+    item->claimed = true;
+    item->done = true;
+    regular = false;
+  }
+  if (regular) {
+    item->key = readKey(entry, seq);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  itemCv.wait(lock, [this]() {
+    return stopping || window.size() < Config::MAX_PREFETCH_FILES;
+  });
+  if (stopping) {
+    throw std::runtime_error("Prefetch cancelled");
+  }
+
+  window.push_back(item);
+  if (regular) {
+    unclaimed.emplace(std::make_pair(item->key, seq), item);
+    workCv.notify_one();
+  }
+  itemCv.notify_all();
+}
+
+// 묶어서 읽을 수 있는 file
+static bool batchable(const ScanEntry& entry) {
+  return static_cast<uint64_t>(entry.st.st_size) <= Config::IO_BATCH_FILE_MAX;
+}
+
+void FilePrefetcher::readerLoop() {
+  IoBatch io;
+  while (true) {
+    std::shared_ptr<Item> item;
+    std::vector<std::shared_ptr<Item>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      workCv.wait(lock, [this]() {
+        return stopping || scanDone || !unclaimed.empty();
+      });
+      if (stopping || unclaimed.empty()) {
+        return;
+      }
+
+      item = std::move(unclaimed.begin()->second);
+      unclaimed.erase(unclaimed.begin());
+      if (item->claimed) {
+        continue;
+      }
+      item->claimed = true;
+
+      // 작은 file은 예산 안에서 다음 file들과 묶음 (memory는 미리 예약)
+      size_t size = static_cast<size_t>(item->entry.st.st_size);
+      if (batchable(item->entry) &&
+          memoryUsed + size <= Config::PREFETCH_MEMORY) {
+        memoryUsed += size;
+        batch.push_back(std::move(item));
+        while (batch.size() < Config::IO_BATCH_FILES && !unclaimed.empty()) {
+          auto next = unclaimed.begin();
+          if (next->second->claimed) {
+            unclaimed.erase(next);
+            continue;
+          }
+          size = static_cast<size_t>(next->second->entry.st.st_size);
+          if (!batchable(next->second->entry) ||
+              memoryUsed + size > Config::PREFETCH_MEMORY) {
+            break;
+          }
+          next->second->claimed = true;
+          memoryUsed += size;
+          batch.push_back(std::move(next->second));
+          unclaimed.erase(next);
+        }
+      }
+    }
+    try {
+      if (batch.empty()) {
+        readFile(item);
+      } else {
+        readBatch(io, batch);
+      }
+    } catch (const std::exception& e) {
+      // 읽던 file을 오류로 끝내 consumer가 기다리지 않도록 함
+      std::lock_guard<std::mutex> lock(mutex);
+      bool reserved = !batch.empty();  // batch는 file 크기만큼 미리 예약
+      if (!reserved) {
+        batch.push_back(item);
+      }
+      for (auto& failed : batch) {
+        if (failed->done) {
+          continue;
+        }
+        if (reserved) {
+          memoryUsed -= static_cast<size_t>(failed->entry.st.st_size);
+        }
+        failed->error = "Failed to read " + root + "/" + failed->entry.path +
+                        ": " + e.what();
+        failed->done = true;
+      }
+      budgetCv.notify_all();
+      itemCv.notify_all();
+    }
+  }
+}
+
+void FilePrefetcher::readFile(const std::shared_ptr<Item>& item) {
+  std::string path = root + "/" + item->entry.path;
+  int fd = openFile(rootFd, item->entry.path);
+  uint64_t remaining =
+      fd >= 0 ? static_cast<uint64_t>(item->entry.st.st_size) : 0;
+  std::string error;
+
+  while (remaining > 0) {
+    size_t n = static_cast<size_t>(
+        std::min<uint64_t>(remaining, Config::PREFETCH_CHUNK_SIZE));
+    std::vector<char> buffer;
+    {
+      // Consumer가 기다리는 head file은 예산을 넘어도 한 chunk 허용
+      std::unique_lock<std::mutex> lock(mutex);
+      budgetCv.wait(lock, [this, &item, n]() {
+        return stopping || memoryUsed + n <= Config::PREFETCH_MEMORY ||
+               (!window.empty() && window.front() == item &&
+                item->chunks.empty());
+      });
+      if (stopping) {
+        break;
+      }
+      memoryUsed += n;
+      if (!pool.empty()) {
+        buffer = std::move(pool.back());
+        pool.pop_back();
+      }
+    }
+
+    buffer.resize(n);
+    size_t got = readFully(fd, buffer.data(), n, error, path);
+    buffer.resize(got);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      memoryUsed -= n - got;
+      if (got > 0) {
+        item->chunks.push_back(std::move(buffer));
+      }
+    }
+    itemCv.notify_all();
+
+    remaining -= got;
+    if (got < n) {
+      break;  // File이 줄었거나 read 오류
+    }
+  }
+
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    item->error = error;
+    item->done = true;
+  }
+  itemCv.notify_all();
+}
+
+// open, read, close를 각각 모든 file에 대해 한 번에 요청
+void FilePrefetcher::readBatch(
+    IoBatch& io, const std::vector<std::shared_ptr<Item>>& batch) {
+  size_t count = batch.size();
+  std::vector<std::string> paths(count);
+  std::vector<int> fds(count, -1);
+  std::vector<int> got(count, 0);
+  std::vector<int> closed(count, 0);
+  std::vector<std::vector<char>> buffers(count);
+  std::vector<std::string> errors(count);
+
+  // 빈 file은 열지 않음
+  for (size_t i = 0; i < count; ++i) {
+    if (batch[i]->entry.st.st_size > 0) {
+      paths[i] = root + "/" + batch[i]->entry.path;
+      io.openBeneath(rootFd, batch[i]->entry.path.c_str(), FILE_FLAGS,
+                     &fds[i]);
+    }
+  }
+  io.run();
+
+  for (size_t i = 0; i < count; ++i) {
+    if (fds[i] >= 0) {
+      buffers[i].resize(static_cast<size_t>(batch[i]->entry.st.st_size));
+      io.read(fds[i], buffers[i].data(), buffers[i].size(), 0, &got[i]);
+    }
+  }
+  io.run();
+
+  for (size_t i = 0; i < count; ++i) {
+    if (fds[i] < 0) {
+      continue;
+    }
+    if (got[i] < 0) {
+      errors[i] = "Failed to read " + paths[i] + ": " + strerror(-got[i]);
+      got[i] = 0;
+    } else if (static_cast<size_t>(got[i]) < buffers[i].size() &&
+               lseek(fds[i], got[i], SEEK_SET) == got[i]) {
+      // 한 번에 다 읽지 못한 나머지 (file이 줄었으면 EOF)
+      got[i] += static_cast<int>(readFully(
+          fds[i], buffers[i].data() + got[i], buffers[i].size() - got[i],
+          errors[i], paths[i]));
+    }
+    io.close(fds[i], &closed[i]);
+  }
+  io.run();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < count; ++i) {
+      Item& item = *batch[i];
+      memoryUsed -= static_cast<size_t>(item.entry.st.st_size) -
+                    static_cast<size_t>(got[i]);
+      if (got[i] > 0) {
+        buffers[i].resize(static_cast<size_t>(got[i]));
+        item.chunks.push_back(std::move(buffers[i]));
+      }
+      item.error = errors[i];
+      item.done = true;
+    }
+    budgetCv.notify_all();
+  }
+  itemCv.notify_all();
+}
+
+// Lock 보유 상태에서 호출
+void FilePrefetcher::release(std::vector<char>& buffer) {
+  memoryUsed -= buffer.size();
+  if (buffer.capacity() >= Config::PREFETCH_CHUNK_SIZE &&
+      pool.size() < Config::PREFETCH_MEMORY / Config::PREFETCH_CHUNK_SIZE) {
+    buffer.clear();
+    pool.push_back(std::move(buffer));
+  }
+  buffer = std::vector<char>();
+  budgetCv.notify_all();
+}
+
+bool FilePrefetcher::next(ScanEntry& entry) {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  // 이전 entry 정리 (reader가 아직 읽는 중이면 끝날 때까지 buffer 반환)
+  if (started) {
+    release(current);
+    if (inlineFd >= 0) {
+      close(inlineFd);
+      inlineFd = -1;
+    }
+
+    std::shared_ptr<Item> item = std::move(window.front());
+    window.pop_front();
+    budgetCv.notify_all();
+    itemCv.notify_all();
+
+    while (true) {
+      for (auto& chunk : item->chunks) {
+        release(chunk);
+      }
+      item->chunks.clear();
+      if (!item->claimed || item->done) {
+        break;
+      }
+      itemCv.wait(lock);
+    }
+  }
+  started = true;
+
+  itemCv.wait(lock, [this]() { return !window.empty() || scanDone; });
+  if (window.empty()) {
+    if (scanError) {
+      std::rethrow_exception(scanError);
+    }
+    return false;
+  }
+
+  Item& item = *window.front();
+  entry = item.entry;
+
+  // Reader가 아직 시작하지 않은 file은 직접 읽음
+  if (S_ISREG(item.entry.st.st_mode) && !item.claimed) {
+    item.claimed = true;
+    inlineFd = openFile(rootFd, item.entry.path);
+    inlineRemaining =
+        inlineFd >= 0 ? static_cast<uint64_t>(item.entry.st.st_size) : 0;
+    item.done = true;
+  }
+  return true;
+}
+
+bool FilePrefetcher::read(const char*& data, size_t& len) {
+  std::unique_lock<std::mutex> lock(mutex);
+  release(current);
+
+  if (inlineFd >= 0) {
+    std::string path = root + "/" + window.front()->entry.path;
+    lock.unlock();
+    if (inlineRemaining == 0) {
+      return false;
+    }
+
+    size_t n = static_cast<size_t>(
+        std::min<uint64_t>(inlineRemaining, Config::PREFETCH_CHUNK_SIZE));
+    inlineBuffer.resize(n);
+
+    std::string error;
+    size_t got = readFully(inlineFd, inlineBuffer.data(), n, error, path);
+    if (!error.empty()) {
+      throw std::runtime_error(error);
+    }
+
+    inlineRemaining = got < n ? 0 : inlineRemaining - got;
+    if (got == 0) {
+      return false;
+    }
+    data = inlineBuffer.data();
+    len = got;
+    return true;
+  }
+
+  Item& item = *window.front();
+  itemCv.wait(lock, [&item]() { return !item.chunks.empty() || item.done; });
+
+  if (!item.chunks.empty()) {
+    current = std::move(item.chunks.front());
+    item.chunks.pop_front();
+    data = current.data();
+    len = current.size();
+    return true;
+  }
+
+  if (!item.error.empty()) {
+    throw std::runtime_error(item.error);
+  }
+  return false;
+}
+
+}  // namespace utils
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dirScanner.h"
+#include "ioBatch.h"
+
+namespace utils {
+
+// Reader thread가 file을 읽는 순서 (archive entry 순서와 무관)
+enum class ReadOrder {
+  Name,    // entry 순서
+  Inode,   // inode 번호 순 (대부분의 fs에서 disk 배치와 유사)
+  Extent   // 첫 extent의 physical offset 순 (FIEMAP, 미지원 시 inode)
+};
+
+// scanTree 결과를 순서대로 전달하면서 다음 file들을 미리 읽어 둠
+// Reader thread가 pool buffer(최대 PREFETCH_MEMORY)에 file 내용을 채우는
+// 동안 consumer는 현재 file을 압축하므로 disk와 CPU가 동시에 동작
+// IO_BATCH_FILE_MAX 이하의 작은 file은 IO_BATCH_FILES개씩 묶어
+// open/read/close를 단계별로 한 번에 요청 (IoBatch)
+class FilePrefetcher {
+ public:
+  // false인 regular file은 entry만 전달하고 data는 읽지 않음
+  // (scan thread에서 호출)
+  using Filter = std::function<bool(const ScanEntry& entry)>;
+
+  // prune, symlinks: scanTree에 전달 (제외된 entry는 전달하지 않음)
+  explicit FilePrefetcher(const std::string& root,
+                          ReadOrder order = ReadOrder::Name,
+                          Filter filter = nullptr, ScanPrune prune = nullptr,
+                          bool symlinks = false);
+  // 이미 scan한 entry를 순서대로 전달 (tree를 다시 scan하지 않음)
+  FilePrefetcher(const std::string& root, std::vector<ScanEntry> entries,
+                 ReadOrder order = ReadOrder::Name, Filter filter = nullptr);
+  ~FilePrefetcher();
+
+  FilePrefetcher(const FilePrefetcher&) = delete;
+  FilePrefetcher& operator=(const FilePrefetcher&) = delete;
+
+  // 다음 entry (false: 끝, scan 오류는 예외)
+  bool next(ScanEntry& entry);
+
+  // 현재 regular file의 다음 data (false: file 끝)
+  // data는 다음 read()/next() 호출 전까지 유효
+  bool read(const char*& data, size_t& len);
+
+ private:
+  struct Item {
+    ScanEntry entry;
+    uint64_t key = 0;  // ReadOrder 기준 정렬 값
+    bool claimed = false;  // reader 또는 consumer가 읽기 시작
+    bool done = false;
+    std::deque<std::vector<char>> chunks;
+    std::string error;
+  };
+
+  void start();
+  void scanLoop();
+  void readerLoop();
+  void readFile(const std::shared_ptr<Item>& item);
+  void readBatch(IoBatch& io, const std::vector<std::shared_ptr<Item>>& batch);
+  void push(const ScanEntry& entry);
+  void release(std::vector<char>& buffer);
+  uint64_t readKey(const ScanEntry& entry, uint64_t seq);
+
+  std::string root;
+  int rootFd = -1;
+  ReadOrder order;
+  Filter filter;
+  ScanPrune prune;
+  bool symlinks;
+  bool listed = false;  // entries를 scan 대신 사용
+  std::vector<ScanEntry> entries;
+  bool extentSupported = true;  // scan thread에서만 사용
+  uint64_t pushed = 0;
+
+  std::mutex mutex;
+  std::condition_variable itemCv;    // window/chunk 변경 (consumer 대기)
+  std::condition_variable workCv;    // 읽을 file 추가 (reader 대기)
+  std::condition_variable budgetCv;  // buffer 반환 또는 head 변경
+
+  std::deque<std::shared_ptr<Item>> window;      // front: 현재 entry
+  // Reader가 읽을 file (key, 순번) 순
+  std::map<std::pair<uint64_t, uint64_t>, std::shared_ptr<Item>> unclaimed;
+  std::vector<std::vector<char>> pool;           // 재사용 buffer
+  size_t memoryUsed = 0;
+  bool scanDone = false;
+  bool stopping = false;
+  std::exception_ptr scanError;
+
+  // Consumer 상태
+  bool started = false;
+  std::vector<char> current;  // read()로 반환한 chunk
+  int inlineFd = -1;  // reader보다 앞선 경우 직접 읽는 file
+  uint64_t inlineRemaining = 0;
+  std::vector<char> inlineBuffer;
+
+  std::thread scanner;
+  std::vector<std::thread> readers;
+};
+
+}  // namespace utils
@@ -0,0 +1,171 @@
+#include "httpResponse.h"
+
+#include <limits.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "config.h"
+
+namespace utils {
+
+struct StatusLine {
+  int status;
+  const char* line;
+};
+
+// 미리 만들어 둔 status line (목록에 없으면 500)
+static constexpr StatusLine STATUS_LINES[] = {
+    {200, "HTTP/1.1 200 OK\r\n"},
+    {202, "HTTP/1.1 202 Accepted\r\n"},
+    {206, "HTTP/1.1 206 Partial Content\r\n"},
+    {400, "HTTP/1.1 400 Bad Request\r\n"},
+    {401, "HTTP/1.1 401 Unauthorized\r\n"},
+    {404, "HTTP/1.1 404 Not Found\r\n"},
+    {409, "HTTP/1.1 409 Conflict\r\n"},
+    {413, "HTTP/1.1 413 Payload Too Large\r\n"},
+    {416, "HTTP/1.1 416 Range Not Satisfiable\r\n"},
+    {500, "HTTP/1.1 500 Internal Server Error\r\n"},
+};
+
+// Linux sendfile 1회 최대 전송량
+static constexpr size_t MAX_SENDFILE_SIZE = 0x7ffff000;
+
+static const char* statusLine(int status) {
+  for (const auto& s : STATUS_LINES) {
+    if (s.status == status) {
+      return s.line;
+    }
+  }
+  return "HTTP/1.1 500 Internal Server Error\r\n";
+}
+
+// Socket buffer에 여유가 생길 때까지 대기
+static void waitWritable(int socket) {
+  pollfd pfd = {};
+  pfd.fd = socket;
+  pfd.events = POLLOUT;
+
+  while (true) {
+    int r = poll(&pfd, 1, Config::HTTP_TIMEOUT_SEC * 1000);
+    if (r > 0) {
+      return;
+    }
+    if (r < 0 && errno == EINTR) {
+      continue;
+    }
+    if (r == 0) {
+      throw std::runtime_error("Timeout while sending");
+    }
+    throw std::runtime_error("Failed to send: " +
+                             std::string(strerror(errno)));
+  }
+}
+
+void sendAllv(int socket, iovec* iov, int count) {
+  while (count > 0) {
+    msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = static_cast<size_t>(std::min(count, IOV_MAX));
+
+    // MSG_NOSIGNAL: SIGPIPE 방지
+    ssize_t n = sendmsg(socket, &msg, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        waitWritable(socket);
+        continue;
+      }
+      throw std::runtime_error("Failed to send: " +
+                               std::string(strerror(errno)));
+    }
+
+    // 전송된 만큼 iovec 이동 (partial write)
+    size_t sent = static_cast<size_t>(n);
+    while (count > 0 && sent >= iov->iov_len) {
+      sent -= iov->iov_len;
+      ++iov;
+      --count;
+    }
+    if (count > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + sent;
+      iov->iov_len -= sent;
+    }
+  }
+}
+
+void sendFile(int socket, int fd, off_t offset, uint64_t length) {
+  while (length > 0) {
+    size_t want = static_cast<size_t>(
+        std::min<uint64_t>(length, MAX_SENDFILE_SIZE));
+    ssize_t n = sendfile(socket, fd, &offset, want);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        waitWritable(socket);
+        continue;
+      }
+      throw std::runtime_error("Failed to send file: " +
+                               std::string(strerror(errno)));
+    }
+    if (n == 0) {
+      throw std::runtime_error("File truncated while sending");
+    }
+    length -= static_cast<uint64_t>(n);
+  }
+}
+
+HttpResponse::HttpResponse(int status) : status(status) {}
+
+HttpResponse& HttpResponse::header(const char* name,
+                                   const std::string& value) {
+  headers.append(name).append(": ").append(value).append("\r\n");
+  return *this;
+}
+
+HttpResponse& HttpResponse::body(std::string data) {
+  owned = std::move(data);
+  return body(owned.data(), owned.size());
+}
+
+HttpResponse& HttpResponse::body(const char* data, size_t len) {
+  this->data = data;
+  dataLen = len;
+  fileFd = -1;
+  return *this;
+}
+
+HttpResponse& HttpResponse::file(int fd, off_t offset, uint64_t length) {
+  fileFd = fd;
+  fileOffset = offset;
+  fileLength = length;
+  data = nullptr;
+  dataLen = 0;
+  return *this;
+}
+
+void HttpResponse::send(int socket) {
+  uint64_t length = fileFd >= 0 ? fileLength : dataLen;
+  std::string tail =
+      "Content-Length: " + std::to_string(length) + "\r\n\r\n";
+
+  const char* line = statusLine(status);
+  iovec iov[4] = {
+      {const_cast<char*>(line), strlen(line)},
+      {headers.data(), headers.size()},
+      {tail.data(), tail.size()},
+      {const_cast<char*>(data), dataLen},
+  };
+  sendAllv(socket, iov, 4);
+
+  if (fileFd >= 0) {
+    sendFile(socket, fileFd, fileOffset, fileLength);
+  }
+}
+
+}  // namespace utils
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace utils {
+
+// HTTP response builder
+// Status line은 미리 만들어 둔 table에서 가져오고, header와 body는
+// 복사 없이 sendmsg(iovec)로 한 번에 전송. File body는 sendfile 사용
+class HttpResponse {
+ public:
+  explicit HttpResponse(int status);
+
+  HttpResponse(const HttpResponse&) = delete;
+  HttpResponse& operator=(const HttpResponse&) = delete;
+
+  // Content-Length는 send()에서 자동 추가
+  HttpResponse& header(const char* name, const std::string& value);
+
+  // 소유하는 body
+  HttpResponse& body(std::string data);
+
+  // 소유하지 않는 body (send()까지 data가 유효해야 함)
+  HttpResponse& body(const char* data, size_t len);
+
+  // File body: fd의 [offset, offset + length) 구간 (fd는 caller가 관리)
+  HttpResponse& file(int fd, off_t offset, uint64_t length);
+
+  // 전부 전송할 때까지 반복 (오류/timeout 시 예외)
+  void send(int socket);
+
+ private:
+  int status;
+  std::string headers;
+  std::string owned;
+  const char* data = nullptr;
+  size_t dataLen = 0;
+  int fileFd = -1;
+  off_t fileOffset = 0;
+  uint64_t fileLength = 0;
+};
+
+// Partial write를 처리하며 iovec 전체 전송
+// Non-blocking socket은 POLLOUT을 기다림 (HTTP_TIMEOUT_SEC)
+void sendAllv(int socket, iovec* iov, int count);
+
+// sendfile로 fd의 [offset, offset + length) 구간 전송
+void sendFile(int socket, int fd, off_t offset, uint64_t length);
+
+}  // namespace utils
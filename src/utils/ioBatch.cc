@@ -0,0 +1,412 @@
+#include "ioBatch.h"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <linux/openat2.h>
+#include <plog/Log.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include "config.h"
+
+namespace utils {
+
+// 요청 하나 (blocking syscall로 다시 실행할 수 있도록 인자를 모두 보관)
+struct IoBatch::Op {
+  uint8_t opcode = 0;
+  int fd = -1;  // 대상 fd 또는 기준 directory
+  const char* path = nullptr;
+  int flags = 0;
+  mode_t mode = 0;
+  void* buf = nullptr;
+  size_t len = 0;
+  int64_t offset = 0;
+  int* res = nullptr;
+  bool done = false;
+  struct stat* st = nullptr;  // stat 요청이면 완료 시 statx 결과를 변환
+  struct statx sx;
+  struct open_how how;  // openat2 요청 (완료까지 유지)
+};
+
+static int result(long r) { return r < 0 ? -errno : static_cast<int>(r); }
+
+static open_how beneath(int flags) {
+  open_how how;
+  memset(&how, 0, sizeof(how));
+  how.flags = static_cast<uint64_t>(flags | O_NOFOLLOW);
+  how.resolve = RESOLVE_BENEATH | RESOLVE_NO_SYMLINKS;
+  return how;
+}
+
+int openBeneath(int root, const std::string& path, int flags) {
+  // dup은 directory offset을 공유하므로 새로 열기
+  if (path.empty()) {
+    return ::openat(root, ".", flags | O_NOFOLLOW);
+  }
+
+  open_how how = beneath(flags);
+  long r = syscall(SYS_openat2, root, path.c_str(), &how, sizeof(how));
+  if (r >= 0 || (errno != ENOSYS && errno != EPERM)) {
+    return static_cast<int>(r);
+  }
+
+  // openat2 미지원 (5.6 미만 또는 seccomp 차단)
+  int fd = root;
+  size_t start = 0;
+  while (true) {
+    size_t end = path.find('/', start);
+    bool last = end == std::string::npos;
+    std::string name = path.substr(start, last ? end : end - start);
+    int next = ::openat(fd, name.c_str(),
+                        last ? flags | O_NOFOLLOW
+                             : O_RDONLY | O_DIRECTORY | O_NOFOLLOW |
+                                   O_CLOEXEC);
+    int err = errno;
+    if (fd != root) {
+      ::close(fd);
+    }
+    if (next < 0 || last) {
+      errno = err;
+      return next;
+    }
+    fd = next;
+    start = end + 1;
+  }
+}
+
+static void toStat(const struct statx& sx, struct stat& st) {
+  memset(&st, 0, sizeof(st));
+  st.st_dev = makedev(sx.stx_dev_major, sx.stx_dev_minor);
+  st.st_ino = sx.stx_ino;
+  st.st_mode = sx.stx_mode;
+  st.st_nlink = sx.stx_nlink;
+  st.st_uid = sx.stx_uid;
+  st.st_gid = sx.stx_gid;
+  st.st_rdev = makedev(sx.stx_rdev_major, sx.stx_rdev_minor);
+  st.st_size = static_cast<off_t>(sx.stx_size);
+  st.st_blksize = static_cast<blksize_t>(sx.stx_blksize);
+  st.st_blocks = static_cast<blkcnt_t>(sx.stx_blocks);
+  st.st_atim = {sx.stx_atime.tv_sec, sx.stx_atime.tv_nsec};
+  st.st_mtim = {sx.stx_mtime.tv_sec, sx.stx_mtime.tv_nsec};
+  st.st_ctim = {sx.stx_ctime.tv_sec, sx.stx_ctime.tv_nsec};
+}
+
+// 사용하는 opcode를 kernel이 모두 지원하는지 (5.6 이상)
+static bool supported(int fd) {
+  const unsigned count = 256;
+  size_t size = sizeof(io_uring_probe) + count * sizeof(io_uring_probe_op);
+  auto* probe = static_cast<io_uring_probe*>(calloc(1, size));
+  if (!probe) {
+    return false;
+  }
+
+  bool ok = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+                    count) == 0;
+  for (int op : {IORING_OP_OPENAT, IORING_OP_OPENAT2, IORING_OP_STATX,
+                 IORING_OP_READ, IORING_OP_WRITE, IORING_OP_CLOSE}) {
+    ok = ok && op <= probe->last_op &&
+         (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+  }
+  free(probe);
+  return ok;
+}
+
+IoBatch::IoBatch() {
+  io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  int fd = static_cast<int>(
+      syscall(__NR_io_uring_setup, Config::IO_URING_DEPTH, &p));
+
+  if (fd >= 0 && supported(fd)) {
+    ringSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      ringSize = std::max(ringSize, cqSize);
+    }
+    sqeSize = p.sq_entries * sizeof(io_uring_sqe);
+
+    ringMap = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    cqMap = single ? ringMap
+                   : mmap(nullptr, cqSize, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    sqeMap = mmap(nullptr, sqeSize, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+    if (ringMap != MAP_FAILED && cqMap != MAP_FAILED &&
+        sqeMap != MAP_FAILED) {
+      auto* sq = static_cast<char*>(ringMap);
+      auto* cq = static_cast<char*>(cqMap);
+      sqHead = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+      sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+      sqMask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+      sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+      cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+      cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+      cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+      cqes = cq + p.cq_off.cqes;
+      entries = p.sq_entries;
+      ringFd = fd;
+      fd = -1;
+    }
+  }
+
+  if (ringFd < 0) {
+    // 일부만 mmap된 경우 정리
+    if (sqeMap && sqeMap != MAP_FAILED) {
+      munmap(sqeMap, sqeSize);
+    }
+    if (cqMap && cqMap != MAP_FAILED && cqMap != ringMap) {
+      munmap(cqMap, cqSize);
+    }
+    if (ringMap && ringMap != MAP_FAILED) {
+      munmap(ringMap, ringSize);
+    }
+    ringMap = cqMap = sqeMap = nullptr;
+    if (fd >= 0) {
+      ::close(fd);
+    }
+
+    static std::atomic<bool> logged{false};
+    if (!logged.exchange(true)) {
+      PLOGI << "io_uring unavailable, using blocking file I/O";
+    }
+    return;
+  }
+
+  ops.reserve(entries);
+}
+
+IoBatch::~IoBatch() {
+  run();
+  shutdown();
+}
+
+// Ring 해제 (이후 요청은 blocking syscall로 처리)
+void IoBatch::shutdown() {
+  if (ringFd < 0) {
+    return;
+  }
+  munmap(sqeMap, sqeSize);
+  if (cqMap != ringMap) {
+    munmap(cqMap, cqSize);
+  }
+  munmap(ringMap, ringSize);
+  ::close(ringFd);
+  ringFd = -1;
+  ops.clear();
+  pending = 0;
+}
+
+// Ring이 있으면 SQE로 추가 (queue가 가득 차면 먼저 실행), 없으면 바로 실행
+void IoBatch::submit(const Op& request) {
+  if (ringFd >= 0 && ops.size() == entries) {
+    run();
+  }
+  if (ringFd < 0) {
+    *request.res = execute(request);
+    return;
+  }
+
+  unsigned tail = *sqTail;
+  unsigned index = tail & sqMask;
+  auto* sqe = static_cast<io_uring_sqe*>(sqeMap) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->user_data = ops.size();
+
+  ops.push_back(request);
+  Op& op = ops.back();
+  sqe->opcode = op.opcode;
+  sqe->fd = op.fd;
+  sqe->addr = reinterpret_cast<uint64_t>(op.path ? op.path : op.buf);
+  switch (op.opcode) {
+    case IORING_OP_OPENAT:
+      sqe->len = op.mode;
+      sqe->open_flags = static_cast<uint32_t>(op.flags);
+      break;
+    case IORING_OP_OPENAT2:
+      op.how = beneath(op.flags);
+      sqe->len = sizeof(op.how);
+      sqe->off = reinterpret_cast<uint64_t>(&op.how);
+      break;
+    case IORING_OP_STATX:
+      sqe->len = STATX_BASIC_STATS;
+      sqe->off = reinterpret_cast<uint64_t>(&op.sx);
+      sqe->statx_flags = static_cast<uint32_t>(op.flags);
+      break;
+    case IORING_OP_READ:
+    case IORING_OP_WRITE:
+      sqe->len = static_cast<uint32_t>(op.len);
+      sqe->off = static_cast<uint64_t>(op.offset);
+      break;
+    default:
+      break;
+  }
+
+  sqArray[index] = index;
+  __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+  ++pending;
+}
+
+// 요청을 blocking syscall로 실행 (결과는 -errno 형식)
+int IoBatch::execute(const Op& op) {
+  switch (op.opcode) {
+    case IORING_OP_OPENAT:
+      return result(::openat(op.fd, op.path, op.flags, op.mode));
+    case IORING_OP_OPENAT2:
+      return result(utils::openBeneath(op.fd, op.path, op.flags));
+    case IORING_OP_STATX:
+      return result(fstatat(op.fd, op.path, op.st, op.flags));
+    case IORING_OP_READ:
+      return result(pread(op.fd, op.buf, op.len, op.offset));
+    case IORING_OP_WRITE:
+      return result(pwrite(op.fd, op.buf, op.len, op.offset));
+    case IORING_OP_CLOSE:
+      return result(::close(op.fd));
+    default:
+      return -EINVAL;
+  }
+}
+
+void IoBatch::openat(int dir, const char* path, int flags, mode_t mode,
+                     int* res) {
+  Op op;
+  op.opcode = IORING_OP_OPENAT;
+  op.fd = dir;
+  op.path = path;
+  op.flags = flags;
+  op.mode = mode;
+  op.res = res;
+  submit(op);
+}
+
+void IoBatch::openBeneath(int dir, const char* path, int flags, int* res) {
+  Op op;
+  op.opcode = IORING_OP_OPENAT2;
+  op.fd = dir;
+  op.path = path;
+  op.flags = flags;
+  op.res = res;
+  submit(op);
+}
+
+void IoBatch::stat(int dir, const char* path, int flags, struct stat* st,
+                   int* res) {
+  Op op;
+  op.opcode = IORING_OP_STATX;
+  op.fd = dir;
+  op.path = path;
+  op.flags = flags;
+  op.st = st;
+  op.res = res;
+  submit(op);
+}
+
+void IoBatch::read(int fd, void* buf, size_t len, int64_t offset, int* res) {
+  Op op;
+  op.opcode = IORING_OP_READ;
+  op.fd = fd;
+  op.buf = buf;
+  op.len = len;
+  op.offset = offset;
+  op.res = res;
+  submit(op);
+}
+
+void IoBatch::write(int fd, const void* buf, size_t len, int64_t offset,
+                    int* res) {
+  Op op;
+  op.opcode = IORING_OP_WRITE;
+  op.fd = fd;
+  op.buf = const_cast<void*>(buf);
+  op.len = len;
+  op.offset = offset;
+  op.res = res;
+  submit(op);
+}
+
+void IoBatch::close(int fd, int* res) {
+  Op op;
+  op.opcode = IORING_OP_CLOSE;
+  op.fd = fd;
+  op.res = res;
+  submit(op);
+}
+
+void IoBatch::reap() {
+  unsigned head = *cqHead;
+  unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    auto* cqe = static_cast<io_uring_cqe*>(cqes) + (head & cqMask);
+    Op& op = ops[cqe->user_data];
+    if (op.st && cqe->res == 0) {
+      toStat(op.sx, *op.st);
+    }
+    *op.res = cqe->res;
+    op.done = true;
+    --pending;
+  }
+  __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+}
+
+void IoBatch::run() {
+  if (ringFd < 0 || ops.empty()) {
+    return;
+  }
+
+  // 아직 제출하지 않은 SQE를 제출하고 모두 완료될 때까지 대기
+  unsigned submit = __atomic_load_n(sqTail, __ATOMIC_RELAXED) -
+                    __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+  while (pending > 0) {
+    long r = syscall(__NR_io_uring_enter, ringFd, submit, pending,
+                     IORING_ENTER_GETEVENTS, nullptr, 0);
+    // EAGAIN/EBUSY: kernel 자원 부족 또는 CQ 가득 참 (완료를 수거 후 재시도)
+    if (r < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      PLOGW << "io_uring_enter failed (" << strerror(errno)
+            << "), using blocking file I/O";
+      fallback();
+      return;
+    }
+    if (r > 0) {
+      submit -= static_cast<unsigned>(r);
+    }
+    reap();
+  }
+  ops.clear();
+}
+
+// io_uring을 더 쓸 수 없는 경우: ring을 해제하고 완료되지 않은 요청을
+// blocking syscall로 다시 실행 (이후 요청도 blocking)
+void IoBatch::fallback() {
+  reap();
+  unsigned unsubmitted = *sqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+  size_t submitted = ops.size() - std::min<size_t>(unsubmitted, ops.size());
+  std::vector<Op> rest;
+  rest.swap(ops);
+  shutdown();
+
+  for (size_t i = 0; i < rest.size(); ++i) {
+    Op& op = rest[i];
+    if (op.done) {
+      continue;
+    }
+    // 제출한 close는 이미 실행되었을 수 있으므로 다시 닫지 않음
+    // (그 사이 다른 thread가 같은 번호의 fd를 열었을 수 있음)
+    if (i < submitted && op.opcode == IORING_OP_CLOSE) {
+      *op.res = 0;
+      continue;
+    }
+    *op.res = execute(op);
+  }
+}
+
+}  // namespace utils
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct io_uring_sqe;
+
+namespace utils {
+
+// root fd 아래 path(상대 경로)를 중간 component 포함 symlink를 따라가지
+// 않고 열기 (openat2 RESOLVE_BENEATH, 미지원 kernel은 component마다
+// O_NOFOLLOW로 열기), path가 비어 있으면 root를 다시 열기, 실패 시 -1
+int openBeneath(int root, const std::string& path, int flags);
+
+// 여러 file의 open/stat/read/write/close 요청을 모아 한 번에 실행
+// io_uring(liburing 없이 syscall 직접 사용)으로 최대 IO_URING_DEPTH개를
+// io_uring_enter 한 번에 제출하고, kernel 미지원/seccomp 차단 등으로 쓸 수
+// 없으면 같은 요청을 blocking syscall로 처리 (호출하는 쪽은 동일)
+//
+// 결과(res)는 syscall 반환값과 같고 실패 시 -errno
+// 경로/buffer는 run()이 끝날 때까지 유효해야 하며, 요청 간 순서는 보장하지
+// 않음 (같은 fd를 쓰는 요청은 run()으로 나눠서 추가)
+// Thread마다 하나씩 사용 (thread-safe 아님)
+class IoBatch {
+ public:
+  IoBatch();
+  ~IoBatch();
+
+  IoBatch(const IoBatch&) = delete;
+  IoBatch& operator=(const IoBatch&) = delete;
+
+  bool uring() const { return ringFd >= 0; }
+
+  void openat(int dir, const char* path, int flags, mode_t mode, int* res);
+  // utils::openBeneath와 같은 결과 (dir 밖이나 symlink는 실패)
+  void openBeneath(int dir, const char* path, int flags, int* res);
+  // fstatat과 같은 결과 (flags: AT_SYMLINK_NOFOLLOW 등)
+  void stat(int dir, const char* path, int flags, struct stat* st, int* res);
+  // 한 번의 pread/pwrite (짧게 끝날 수 있음)
+  void read(int fd, void* buf, size_t len, int64_t offset, int* res);
+  void write(int fd, const void* buf, size_t len, int64_t offset, int* res);
+  void close(int fd, int* res);
+
+  // 추가한 요청을 모두 실행하고 완료까지 대기
+  // (io_uring_enter가 실패하면 ring을 해제하고 완료되지 않은 요청과 이후
+  // 요청은 blocking syscall로 처리, 예외 없음)
+  void run();
+
+ private:
+  struct Op;
+
+  void submit(const Op& request);
+  static int execute(const Op& op);
+  void reap();
+  void fallback();
+  void shutdown();
+
+  int ringFd = -1;
+  void* ringMap = nullptr;
+  size_t ringSize = 0;
+  void* cqMap = nullptr;  // SINGLE_MMAP 미지원 kernel
+  size_t cqSize = 0;
+  void* sqeMap = nullptr;
+  size_t sqeSize = 0;
+
+  unsigned* sqHead = nullptr;
+  unsigned* sqTail = nullptr;
+  unsigned sqMask = 0;
+  unsigned* sqArray = nullptr;
+  unsigned* cqHead = nullptr;
+  unsigned* cqTail = nullptr;
+  unsigned cqMask = 0;
+  void* cqes = nullptr;
+  unsigned entries = 0;
+
+  std::vector<Op> ops;   // 제출 대기/실행 중 (index = user_data)
+  unsigned pending = 0;  // 아직 완료되지 않은 요청 수
+};
+
+}  // namespace utils
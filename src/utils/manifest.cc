@@ -0,0 +1,113 @@
+#include "manifest.h"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace utils {
+
+static int64_t mtimeNs(const struct stat& st) {
+  return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+         st.st_mtim.tv_nsec;
+}
+
+void Manifest::append(Entry entry) {
+  hash.add(entry.path);
+  uint64_t fields[] = {entry.mode, entry.size,
+                       static_cast<uint64_t>(entry.mtime_ns)};
+  hash.add(fields, sizeof(fields));
+
+  index[entry.path] = entries.size();
+  entries.push_back(std::move(entry));
+}
+
+void Manifest::add(const ScanEntry& entry) {
+  Entry e;
+  e.path = entry.path;
+  e.mode = static_cast<uint32_t>(entry.st.st_mode);
+  e.size = static_cast<uint64_t>(entry.st.st_size);
+  e.mtime_ns = mtimeNs(entry.st);
+  append(std::move(e));
+}
+
+bool Manifest::changed(const ScanEntry& entry) const {
+  auto it = index.find(entry.path);
+  if (it == index.end()) {
+    return true;
+  }
+
+  const Entry& e = entries[it->second];
+  if (e.mode != static_cast<uint32_t>(entry.st.st_mode)) {
+    return true;
+  }
+  // Directory는 mode만 비교 (mtime은 child 변경마다 바뀜)
+  if (S_ISDIR(entry.st.st_mode)) {
+    return false;
+  }
+  return e.size != static_cast<uint64_t>(entry.st.st_size) ||
+         e.mtime_ns != mtimeNs(entry.st);
+}
+
+std::string Manifest::layoutId() const {
+  TreeHash layout;
+  for (const Entry& e : entries) {
+    layout.add(e.path);
+    uint64_t fields[] = {e.mode, S_ISDIR(e.mode) ? 0 : e.size};
+    layout.add(fields, sizeof(fields));
+  }
+  return layout.hex();
+}
+
+std::vector<std::string> Manifest::removedIn(const Manifest& current) const {
+  // 삭제된 directory의 하위 entry는 생략 (pre-order이므로 바로 뒤에 옴)
+  std::vector<std::string> removed;
+  std::string removed_dir;
+  for (const Entry& e : entries) {
+    if (!removed_dir.empty() && e.path.size() > removed_dir.size() &&
+        e.path.compare(0, removed_dir.size(), removed_dir) == 0) {
+      continue;
+    }
+    if (current.index.count(e.path) == 0) {
+      removed.push_back(e.path);
+      removed_dir = S_ISDIR(e.mode) ? e.path + "/" : "";
+    }
+  }
+  return removed;
+}
+
+// 형식: "<mode> <size> <mtime_ns> <path>\0" 반복 (경로에 개행 허용)
+bool Manifest::load(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  Manifest loaded;
+  Entry e;
+  while (file >> e.mode >> e.size >> e.mtime_ns) {
+    if (file.get() != ' ' || !std::getline(file, e.path, '\0') ||
+        e.path.empty()) {
+      return false;
+    }
+    loaded.append(e);
+  }
+  if (!file.eof()) {
+    return false;
+  }
+
+  *this = std::move(loaded);
+  return true;
+}
+
+void Manifest::save(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  for (const Entry& e : entries) {
+    file << e.mode << ' ' << e.size << ' ' << e.mtime_ns << ' ' << e.path;
+    file.put('\0');
+  }
+  file.flush();
+  if (!file) {
+    throw std::runtime_error("Failed to write manifest");
+  }
+}
+
+}  // namespace utils
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dirScanner.h"
+#include "treeHash.h"
+
+namespace utils {
+
+// Snapshot 시점의 workspace entry 목록 (incremental archive의 비교 기준)
+// inode/ctime은 extract 후 달라지므로 mode, size, mtime만 기록
+class Manifest {
+ public:
+  struct Entry {
+    std::string path;
+    uint32_t mode = 0;
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+  };
+
+  void add(const ScanEntry& entry);
+
+  // base 이후 추가되었거나 내용/mode가 바뀐 entry인지
+  bool changed(const ScanEntry& entry) const;
+
+  // 이 manifest에는 있지만 current에는 없는 경로 (삭제된 entry)
+  // 삭제된 directory는 directory 경로만 포함
+  std::vector<std::string> removedIn(const Manifest& current) const;
+
+  // Entry 목록의 hash (snapshot id)
+  std::string id() const { return hash.hex(); }
+  // 경로, mode, size(directory 제외)만의 hash
+  // mtime은 extract에서 유지되지 않으므로 다른 곳에 해제한 tree와 비교할 때
+  std::string layoutId() const;
+  size_t size() const { return entries.size(); }
+
+  // 실패 시 false / 예외 (save)
+  bool load(const std::string& path);
+  void save(const std::string& path) const;
+
+ private:
+  void append(Entry entry);
+
+  std::vector<Entry> entries;  // scan 순서
+  std::unordered_map<std::string, size_t> index;
+  TreeHash hash;
+};
+
+}  // namespace utils
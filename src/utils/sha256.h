@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace utils {
+
+// SHA-256 (FIPS 180-4), chunk store 주소용
+class Sha256 {
+ public:
+  using Digest = std::array<uint8_t, 32>;
+
+  Sha256();
+
+  void update(const void* data, size_t len);
+  Digest finish();
+
+  static std::string hex(const Digest& digest);
+
+  // 한 번에 계산 (hex)
+  static std::string hash(const void* data, size_t len);
+
+ private:
+  void transform(const uint8_t* block);
+
+  uint32_t state[8];
+  uint8_t buffer[64];
+  size_t buffered = 0;
+  uint64_t total = 0;
+};
+
+}  // namespace utils
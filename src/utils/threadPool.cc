@@ -0,0 +1,78 @@
+#include "threadPool.h"
+
+#include <plog/Log.h>
+#include <signal.h>
+
+#include <exception>
+
+namespace utils {
+
+ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0) {
+    threads = 1;
+  }
+
+  workers.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    workers.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() { join(); }
+
+void ThreadPool::join() {
+  {
+    std::lock_guard<std::mutex> lock(taskMutex);
+    stopping = true;
+  }
+  taskCv.notify_all();
+
+  for (auto& worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(taskMutex);
+    tasks.push(std::move(task));
+  }
+  taskCv.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+  // Signal은 main thread에서만 처리
+  sigset_t mask;
+  sigemptyset(&mask);
+  sigaddset(&mask, SIGINT);
+  sigaddset(&mask, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(taskMutex);
+      taskCv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+
+      // 종료 시에도 남은 작업은 모두 처리
+      if (tasks.empty()) {
+        return;
+      }
+
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+
+    try {
+      task();
+    } catch (const std::exception& e) {
+      PLOGE << "Worker error: " << e.what();
+    } catch (...) {
+      PLOGE << "Worker error: unknown exception";
+    }
+  }
+}
+
+}  // namespace utils
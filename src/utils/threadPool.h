@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace utils {
+
+// 고정 크기 worker pool
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t threads);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  void post(std::function<void()> task);
+
+  // 결과가 필요한 작업은 future로 반환
+  template <typename F>
+  auto submit(F&& f) -> std::future<std::invoke_result_t<F>> {
+    using R = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+    std::future<R> result = task->get_future();
+    post([task]() { (*task)(); });
+    return result;
+  }
+
+  size_t size() const { return workers.size(); }
+
+  // 남은 작업을 모두 처리한 뒤 worker 종료 (이후 post된 작업은 실행 안 됨)
+  void join();
+
+ private:
+  void workerLoop();
+
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> tasks;
+  std::mutex taskMutex;
+  std::condition_variable taskCv;
+  bool stopping = false;
+};
+
+}  // namespace utils
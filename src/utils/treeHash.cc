@@ -0,0 +1,45 @@
+#include "treeHash.h"
+
+#include <cstdio>
+
+namespace utils {
+
+void TreeHash::add(const void* data, size_t len) {
+  const auto* p = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < len; ++i) {
+    hash ^= p[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+void TreeHash::add(const std::string& str) {
+  // 경계 구분을 위해 '\0' 포함
+  add(str.c_str(), str.size() + 1);
+}
+
+void TreeHash::add(const ScanEntry& entry) {
+  add(entry.path);
+
+  const struct stat& st = entry.st;
+  uint64_t fields[] = {
+      static_cast<uint64_t>(st.st_mode),
+      static_cast<uint64_t>(st.st_size),
+      static_cast<uint64_t>(st.st_mtim.tv_sec),
+      static_cast<uint64_t>(st.st_mtim.tv_nsec),
+      static_cast<uint64_t>(st.st_ctim.tv_sec),
+      static_cast<uint64_t>(st.st_ctim.tv_nsec),
+      static_cast<uint64_t>(st.st_ino),
+      static_cast<uint64_t>(st.st_dev),
+      static_cast<uint64_t>(st.st_uid),
+      static_cast<uint64_t>(st.st_gid),
+  };
+  add(fields, sizeof(fields));
+}
+
+std::string TreeHash::hex() const {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+  return buf;
+}
+
+}  // namespace utils
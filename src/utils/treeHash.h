@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "dirScanner.h"
+
+namespace utils {
+
+// Workspace tree fingerprint (FNV-1a 64bit)
+// entry 순서가 같아야 같은 값 (scanTree는 이름순)
+class TreeHash {
+ public:
+  void add(const void* data, size_t len);
+  void add(const std::string& str);
+
+  // 경로, type/mode, size, mtime/ctime, inode
+  void add(const ScanEntry& entry);
+
+  uint64_t value() const { return hash; }
+  std::string hex() const;
+
+ private:
+  uint64_t hash = 14695981039346656037ULL;
+};
+
+}  // namespace utils
@@ -0,0 +1,838 @@
+#include "treeWriter.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "config.h"
+
+namespace utils {
+
+// "", "." component는 무시, ".."는 오류
+static std::vector<std::string> splitComponents(const std::string& path) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = path.find('/', start);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+    std::string part = path.substr(start, end - start);
+    if (part == "..") {
+      throw std::runtime_error("Invalid path detected: " + path);
+    }
+    if (!part.empty() && part != ".") {
+      parts.push_back(std::move(part));
+    }
+    start = end + 1;
+  }
+  if (parts.empty() ||
+      parts.size() > static_cast<size_t>(Config::MAX_RECURSION_DEPTH)) {
+    throw std::runtime_error("Invalid path detected: " + path);
+  }
+  return parts;
+}
+
+// parts[0, count)를 '/'로 이은 cache key
+static std::string joinComponents(const std::vector<std::string>& parts,
+                                  size_t count) {
+  std::string key;
+  for (size_t i = 0; i < count; ++i) {
+    if (i > 0) {
+      key += '/';
+    }
+    key += parts[i];
+  }
+  return key;
+}
+
+// 기존 entry 삭제 (directory면 subtree째, symlink는 따라가지 않음)
+// directory를 지웠으면 true
+static bool removeAt(int dir, const std::string& name) {
+  if (unlinkat(dir, name.c_str(), 0) == 0 || errno == ENOENT) {
+    return false;
+  }
+  if (errno != EISDIR && errno != EPERM) {
+    throw std::runtime_error("Failed to remove " + name + ": " +
+                             strerror(errno));
+  }
+
+  int fd = openat(dir, name.c_str(),
+                  O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  DIR* d = fd >= 0 ? fdopendir(fd) : nullptr;
+  if (!d) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    throw std::runtime_error("Failed to remove " + name + ": " +
+                             strerror(errno));
+  }
+
+  // 읽는 도중 삭제하지 않도록 목록을 먼저 만듦
+  std::vector<std::string> children;
+  while (dirent* entry = readdir(d)) {
+    if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+      children.emplace_back(entry->d_name);
+    }
+  }
+  try {
+    for (const std::string& child : children) {
+      removeAt(dirfd(d), child);
+    }
+  } catch (...) {
+    closedir(d);
+    throw;
+  }
+  closedir(d);
+
+  if (unlinkat(dir, name.c_str(), AT_REMOVEDIR) != 0 && errno != ENOENT) {
+    throw std::runtime_error("Failed to remove " + name + ": " +
+                             strerror(errno));
+  }
+  return true;
+}
+
+// 현재 umask (/proc/self/status, 알 수 없으면 -1)
+// umask()는 값을 바꿔야 읽을 수 있어 다른 thread의 file 생성과 경합
+static int processUmask() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "Umask:") == 0) {
+      return static_cast<int>(strtol(line.c_str() + 6, nullptr, 8));
+    }
+  }
+  return -1;
+}
+
+static bool setDirect(int fd, bool on) {
+  int flags = fcntl(fd, F_GETFL);
+  return flags >= 0 &&
+         fcntl(fd, F_SETFL, on ? flags | O_DIRECT : flags & ~O_DIRECT) == 0;
+}
+
+static bool pwriteAll(int fd, const char* data, size_t len, int64_t offset) {
+  while (len > 0) {
+    ssize_t n = pwrite(fd, data, len, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    len -= static_cast<size_t>(n);
+    offset += n;
+  }
+  return true;
+}
+
+TreeWriter::DirFd::~DirFd() {
+  if (fd >= 0) {
+    close(fd);
+  }
+}
+
+TreeWriter::TreeWriter(const std::string& root, size_t threads) {
+  int fd = open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open directory " + root);
+  }
+  rootDir = std::make_shared<DirFd>(fd);
+  writers = std::make_unique<ThreadPool>(threads);
+}
+
+TreeWriter::~TreeWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    aborted = true;
+    if (current) {
+      current->complete = true;
+    }
+  }
+  dataCv.notify_all();
+  writers.reset();
+}
+
+// Cache에 없으면 상위 directory(재귀적으로 cache 사용)에서 openat
+// 여러 thread가 같은 directory를 동시에 열면 먼저 등록된 fd를 사용
+TreeWriter::DirRef TreeWriter::openDir(const std::vector<std::string>& parts,
+                                       size_t count, bool create) {
+  if (count == 0) {
+    return rootDir;
+  }
+
+  std::string key = joinComponents(parts, count);
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = dirCache.find(key);
+    if (it != dirCache.end()) {
+      lru.splice(lru.begin(), lru, it->second.second);
+      return it->second.first;
+    }
+  }
+
+  DirRef parent = openDir(parts, count - 1, create);
+  if (!parent) {
+    return nullptr;
+  }
+
+  const char* part = parts[count - 1].c_str();
+  const int flags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+  int fd = openat(parent->fd, part, flags);
+  if (fd < 0 && errno == ENOENT && create &&
+      (mkdirat(parent->fd, part, 0755) == 0 || errno == EEXIST)) {
+    fd = openat(parent->fd, part, flags);
+  }
+  if (fd < 0) {
+    if (!create && (errno == ENOENT || errno == ENOTDIR)) {
+      return nullptr;
+    }
+    throw std::runtime_error("Failed to open directory " + key + ": " +
+                             strerror(errno));
+  }
+  DirRef dir = std::make_shared<DirFd>(fd);
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  auto it = dirCache.find(key);
+  if (it != dirCache.end()) {
+    return it->second.first;
+  }
+  lru.push_front(key);
+  dirCache.emplace(std::move(key), std::make_pair(dir, lru.begin()));
+  // 사용 중인 fd는 DirRef가 남아 있는 동안 열려 있음
+  while (dirCache.size() > Config::EXTRACT_DIR_CACHE) {
+    dirCache.erase(lru.back());
+    lru.pop_back();
+  }
+  return dir;
+}
+
+TreeWriter::DirRef TreeWriter::openParent(const std::string& path,
+                                          std::string& name, bool create) {
+  std::vector<std::string> parts = splitComponents(path);
+  name = parts.back();
+  return openDir(parts, parts.size() - 1, create);
+}
+
+void TreeWriter::invalidate(const std::string& path) {
+  std::vector<std::string> parts = splitComponents(path);
+  std::string key = joinComponents(parts, parts.size());
+  std::string prefix = key + "/";
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  for (auto it = dirCache.begin(); it != dirCache.end();) {
+    if (it->first == key || it->first.compare(0, prefix.size(), prefix) == 0) {
+      lru.erase(it->second.second);
+      it = dirCache.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+template <typename Create>
+int TreeWriter::createReplacing(const DirRef& dir, const std::string& path,
+                                const std::string& name, Create create) {
+  int r = create();
+  if (r < 0 && errno == EEXIST) {
+    if (removeAt(dir->fd, name)) {
+      invalidate(path);
+    }
+    r = create();
+  }
+  return r;
+}
+
+void TreeWriter::checkError() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+}
+
+void TreeWriter::waitPath(const std::string& path) {
+  bool busy;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    busy = inflight.count(path) > 0;
+  }
+  if (busy) {
+    flushBatch();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  doneCv.wait(lock, [this, &path]() {
+    return inflight.count(path) == 0 || !error.empty();
+  });
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+}
+
+void TreeWriter::waitAll() {
+  flushBatch();
+
+  std::unique_lock<std::mutex> lock(mutex);
+  doneCv.wait(lock, [this]() { return running == 0; });
+  if (!error.empty()) {
+    throw std::runtime_error(error);
+  }
+}
+
+void TreeWriter::directory(const std::string& path, mode_t mode) {
+  waitPath(path);
+
+  std::string name;
+  DirRef dir = openParent(path, name);
+  int r = mkdirat(dir->fd, name.c_str(), 0700);
+  if (r != 0 && errno == EEXIST) {
+    struct stat st;
+    if (fstatat(dir->fd, name.c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+        S_ISDIR(st.st_mode)) {
+      r = 0;
+    } else {
+      // File -> directory로 바뀐 entry
+      r = createReplacing(dir, path, name, [&dir, &name]() {
+        return mkdirat(dir->fd, name.c_str(), 0700);
+      });
+    }
+  }
+  int err = errno;
+  if (r != 0) {
+    throw std::runtime_error("Failed to create directory " + path + ": " +
+                             strerror(err));
+  }
+
+  // 쓰기 권한이 없는 directory도 채울 수 있도록 mode는 finish()에서 적용
+  dirModes.emplace_back(path, mode);
+}
+
+void TreeWriter::beginFile(const std::string& path, mode_t mode,
+                           uint64_t size, timespec mtime, bool sparse) {
+  waitPath(path);
+
+  current = std::make_shared<FileJob>();
+  current->path = path;
+  current->mode = mode;
+  current->size = size;
+  current->sparse = sparse;
+  current->mtime = mtime;
+  submitted = false;
+  remaining = size;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  inflight[path] = current;
+}
+
+void TreeWriter::write(const void* data, size_t len, int64_t offset) {
+  const char* p = static_cast<const char*>(data);
+  while (len > 0) {
+    // 이어지지 않는 offset(sparse)은 새 chunk로
+    if (!pending.data.empty() &&
+        pending.offset + static_cast<int64_t>(pending.data.size()) != offset) {
+      flushPending();
+    }
+
+    if (pending.data.size() == pending.data.capacity()) {
+      flushPending();
+
+      size_t want = static_cast<size_t>(std::min<uint64_t>(
+          Config::EXTRACT_CHUNK_SIZE, std::max<uint64_t>(remaining, len)));
+      std::unique_lock<std::mutex> lock(mutex);
+      memoryCv.wait(lock, [this, want]() {
+        return memoryUsed == 0 ||
+               memoryUsed + want <= Config::EXTRACT_MEMORY || !error.empty();
+      });
+      if (!error.empty()) {
+        throw std::runtime_error(error);
+      }
+      if (want == Config::EXTRACT_CHUNK_SIZE && !pool.empty()) {
+        pending.data = std::move(pool.back());
+        pool.pop_back();
+      } else {
+        pending.data.reserve(want);
+      }
+      memoryUsed += pending.data.capacity();
+      pending.offset = offset;
+    }
+
+    size_t n = std::min(len, pending.data.capacity() - pending.data.size());
+    pending.data.insert(pending.data.end(), p, p + n);
+    p += n;
+    len -= n;
+    offset += static_cast<int64_t>(n);
+    remaining = remaining > n ? remaining - n : 0;
+  }
+}
+
+// pending을 현재 job으로 전달
+// buffer를 다 채운 큰 file은 endFile 전에 writer에 넘겨 해제와 겹치게 함
+void TreeWriter::flushPending() {
+  if (pending.data.capacity() == 0) {
+    return;
+  }
+  if (pending.data.empty()) {
+    release(pending.data);
+    return;
+  }
+
+  bool full = pending.data.size() == pending.data.capacity();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    current->chunks.push_back(std::move(pending));
+  }
+  dataCv.notify_all();
+  pending = Chunk();
+
+  if (full && !submitted) {
+    submitCurrent();
+  }
+}
+
+void TreeWriter::endFile() {
+  flushPending();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    current->complete = true;
+  }
+  dataCv.notify_all();
+  if (!submitted) {
+    // Data가 한 chunk인 작은 file은 모아서 제출
+    if (current->size <= Config::IO_BATCH_FILE_MAX &&
+        current->size < Config::EXTRACT_PREALLOCATE_MIN && !current->sparse &&
+        current->chunks.size() <= 1) {
+      batch.push_back(std::move(current));
+      if (batch.size() >= Config::IO_BATCH_FILES) {
+        flushBatch();
+      }
+    } else {
+      submitCurrent();
+    }
+  }
+  current.reset();
+}
+
+void TreeWriter::flushBatch() {
+  if (batch.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++running;
+  }
+  std::vector<std::shared_ptr<FileJob>> jobs;
+  jobs.swap(batch);
+  writers->post([this, jobs]() { writeBatch(jobs); });
+}
+
+void TreeWriter::submitCurrent() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++running;
+  }
+  submitted = true;
+  std::shared_ptr<FileJob> job = current;
+  writers->post([this, job]() { writeFile(job); });
+}
+
+void TreeWriter::release(std::vector<char>& buffer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    memoryUsed -= buffer.capacity();
+    if (buffer.capacity() == Config::EXTRACT_CHUNK_SIZE &&
+        pool.size() * Config::EXTRACT_CHUNK_SIZE < Config::EXTRACT_MEMORY) {
+      buffer.clear();
+      pool.push_back(std::move(buffer));
+    }
+  }
+  buffer = std::vector<char>();
+  memoryCv.notify_all();
+}
+
+void TreeWriter::writeFile(const std::shared_ptr<FileJob>& job) {
+  std::string failure;
+  int fd = -1;
+
+  bool skip;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    skip = aborted || !error.empty();
+  }
+  if (!skip) {
+    try {
+      std::string name;
+      DirRef dir = openParent(job->path, name);
+      fd = createReplacing(dir, job->path, name, [&dir, &name]() {
+        return openat(dir->fd, name.c_str(),
+                      O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                      0600);
+      });
+      int err = errno;
+      if (fd < 0) {
+        throw std::runtime_error("Failed to create " + job->path + ": " +
+                                 strerror(err));
+      }
+    } catch (const std::exception& e) {
+      failure = e.what();
+    }
+  }
+
+  // 연속된 extent로 할당 (미지원 filesystem이면 그냥 기록)
+  if (fd >= 0 && !job->sparse &&
+      job->size >= Config::EXTRACT_PREALLOCATE_MIN) {
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(job->size));
+  }
+
+  // O_DIRECT는 정렬된 buffer가 필요하므로 pool buffer를 복사해 기록
+  std::unique_ptr<char, decltype(&free)> bounce(nullptr, &free);
+  if (fd >= 0 && Config::EXTRACT_DIRECT_MIN > 0 &&
+      job->size >= Config::EXTRACT_DIRECT_MIN) {
+    void* p = nullptr;
+    if (posix_memalign(&p, Config::DIRECT_IO_ALIGN,
+                       Config::EXTRACT_CHUNK_SIZE) == 0) {
+      bounce.reset(static_cast<char*>(p));
+      if (!setDirect(fd, true)) {
+        bounce.reset();
+      }
+    }
+  }
+  int64_t end = 0;  // 기록한 마지막 위치
+
+  while (true) {
+    Chunk chunk;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      dataCv.wait(lock, [this, &job]() {
+        return !job->chunks.empty() || job->complete || aborted;
+      });
+      if (job->chunks.empty()) {
+        break;
+      }
+      chunk = std::move(job->chunks.front());
+      job->chunks.pop_front();
+    }
+
+    if (fd >= 0 && failure.empty()) {
+      const char* data = chunk.data.data();
+      size_t len = chunk.data.size();
+      if (bounce && (chunk.offset % Config::DIRECT_IO_ALIGN != 0 ||
+                     len % Config::DIRECT_IO_ALIGN != 0 ||
+                     len > Config::EXTRACT_CHUNK_SIZE)) {
+        // 끝부분 등 정렬되지 않은 chunk부터는 buffered
+        setDirect(fd, false);
+        bounce.reset();
+      }
+      bool written;
+      if (bounce) {
+        memcpy(bounce.get(), data, len);
+        written = pwriteAll(fd, bounce.get(), len, chunk.offset);
+        if (!written && errno == EINVAL) {
+          // Filesystem이 요구하는 정렬이 더 큰 경우
+          setDirect(fd, false);
+          bounce.reset();
+          written = pwriteAll(fd, data, len, chunk.offset);
+        }
+      } else {
+        written = pwriteAll(fd, data, len, chunk.offset);
+      }
+      if (!written) {
+        failure = "Failed to write " + job->path + ": " + strerror(errno);
+      }
+      end = std::max(end, chunk.offset + static_cast<int64_t>(len));
+    }
+    release(chunk.data);
+  }
+
+  if (fd >= 0) {
+    // 끝이 hole인 sparse file은 크기만 맞춤
+    if (failure.empty() && job->sparse &&
+        end < static_cast<int64_t>(job->size) &&
+        ftruncate(fd, static_cast<off_t>(job->size)) != 0) {
+      failure = "Failed to set size for " + job->path + ": " + strerror(errno);
+    }
+    // Owner를 복원하지 않으므로 setuid/setgid는 제외
+    if (failure.empty() && fchmod(fd, job->mode & 01777) != 0) {
+      failure = "Failed to set mode for " + job->path + ": " + strerror(errno);
+    }
+    const timespec times[2] = {{0, UTIME_OMIT}, job->mtime};
+    if (failure.empty() && job->mtime.tv_nsec != UTIME_OMIT &&
+        futimens(fd, times) != 0) {
+      failure = "Failed to set mtime for " + job->path + ": " + strerror(errno);
+    }
+    close(fd);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    finishJob(job, failure);
+    --running;
+  }
+  doneCv.notify_all();
+  memoryCv.notify_all();
+}
+
+// 여러 file의 create, write, close를 단계마다 한 번에 요청
+// 같은 경로의 file은 한 batch에 들어가지 않음 (beginFile의 waitPath)
+void TreeWriter::writeBatch(const std::vector<std::shared_ptr<FileJob>>& jobs) {
+  static thread_local IoBatch io;
+  // umask로 줄어들지 않는 mode는 생성할 때 바로 지정 (fchmod 생략)
+  static const int mask = processUmask();
+  const int flags = O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC;
+
+  size_t count = jobs.size();
+  std::vector<DirRef> dirs(count);
+  std::vector<std::string> names(count);
+  std::vector<Chunk> chunks(count);
+  std::vector<int> fds(count, -1);
+  std::vector<int> results(count, 0);
+  std::vector<std::string> failures(count);
+
+  bool skip;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    skip = aborted || !error.empty();
+    for (size_t i = 0; i < count; ++i) {
+      if (!jobs[i]->chunks.empty()) {
+        chunks[i] = std::move(jobs[i]->chunks.front());
+        jobs[i]->chunks.clear();
+      }
+    }
+  }
+
+  try {
+    for (size_t i = 0; i < count && !skip; ++i) {
+      try {
+        dirs[i] = openParent(jobs[i]->path, names[i]);
+        io.openat(dirs[i]->fd, names[i].c_str(), flags, jobs[i]->mode & 0777,
+                  &results[i]);
+      } catch (const std::exception& e) {
+        failures[i] = e.what();
+      }
+    }
+    io.run();
+
+    for (size_t i = 0; i < count && !skip; ++i) {
+      const FileJob& job = *jobs[i];
+      if (!failures[i].empty()) {
+        continue;
+      }
+
+      bool replaced = results[i] == -EEXIST;
+      if (replaced) {
+        const DirRef& dir = dirs[i];
+        const std::string& name = names[i];
+        results[i] = createReplacing(dir, job.path, name, [&]() {
+          return openat(dir->fd, name.c_str(), flags, 0600);
+        });
+        results[i] = results[i] < 0 ? -errno : results[i];
+      }
+      if (results[i] < 0) {
+        failures[i] =
+            "Failed to create " + job.path + ": " + strerror(-results[i]);
+        continue;
+      }
+      fds[i] = results[i];
+
+      // 다시 생성한 file(0600)이나 umask에 걸리는 mode만 fchmod
+      mode_t mode = job.mode & 01777;
+      if ((replaced || mask < 0 || (mode & (mask | 01000)) != 0) &&
+          fchmod(fds[i], mode) != 0) {
+        failures[i] =
+            "Failed to set mode for " + job.path + ": " + strerror(errno);
+      }
+
+      results[i] = 0;
+      if (failures[i].empty() && !chunks[i].data.empty()) {
+        io.write(fds[i], chunks[i].data.data(), chunks[i].data.size(),
+                 chunks[i].offset, &results[i]);
+      }
+    }
+    io.run();
+
+    for (size_t i = 0; i < count; ++i) {
+      const FileJob& job = *jobs[i];
+      if (fds[i] < 0 || !failures[i].empty()) {
+        continue;
+      }
+
+      // 짧게 끝난 write의 나머지
+      const Chunk& chunk = chunks[i];
+      size_t done = results[i] > 0 ? static_cast<size_t>(results[i]) : 0;
+      if (results[i] < 0) {
+        failures[i] =
+            "Failed to write " + job.path + ": " + strerror(-results[i]);
+      } else if (done < chunk.data.size() &&
+                 !pwriteAll(fds[i], chunk.data.data() + done,
+                            chunk.data.size() - done,
+                            chunk.offset + static_cast<int64_t>(done))) {
+        failures[i] = "Failed to write " + job.path + ": " + strerror(errno);
+      }
+
+      const timespec times[2] = {{0, UTIME_OMIT}, job.mtime};
+      if (failures[i].empty() && job.mtime.tv_nsec != UTIME_OMIT &&
+          futimens(fds[i], times) != 0) {
+        failures[i] =
+            "Failed to set mtime for " + job.path + ": " + strerror(errno);
+      }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      if (fds[i] >= 0) {
+        io.close(fds[i], &results[i]);
+        fds[i] = -1;
+      }
+    }
+    io.run();
+  } catch (const std::exception& e) {
+    // 예외(memory 부족 등): 남은 file은 직접 닫고 batch 전체를 실패 처리
+    for (size_t i = 0; i < count; ++i) {
+      if (fds[i] >= 0) {
+        close(fds[i]);
+      }
+      if (failures[i].empty()) {
+        failures[i] = e.what();
+      }
+    }
+  }
+
+  for (Chunk& chunk : chunks) {
+    if (chunk.data.capacity() > 0) {
+      release(chunk.data);
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < count; ++i) {
+      finishJob(jobs[i], failures[i]);
+    }
+    --running;
+  }
+  doneCv.notify_all();
+  memoryCv.notify_all();
+}
+
+// Lock 보유 상태에서 호출
+void TreeWriter::finishJob(const std::shared_ptr<FileJob>& job,
+                           const std::string& failure) {
+  if (!failure.empty() && error.empty()) {
+    error = failure;
+  }
+  auto it = inflight.find(job->path);
+  if (it != inflight.end() && it->second == job) {
+    inflight.erase(it);
+  }
+}
+
+void TreeWriter::symlink(const std::string& path, const std::string& target) {
+  waitPath(path);
+
+  std::string name;
+  DirRef dir = openParent(path, name);
+  int r = createReplacing(dir, path, name, [&dir, &name, &target]() {
+    return symlinkat(target.c_str(), dir->fd, name.c_str());
+  });
+  int err = errno;
+  if (r != 0) {
+    throw std::runtime_error("Failed to create symlink " + path + ": " +
+                             strerror(err));
+  }
+}
+
+void TreeWriter::hardlink(const std::string& path, const std::string& target) {
+  // 대상 file이 아직 기록 중이면 완료 후 link
+  waitPath(target);
+  waitPath(path);
+
+  std::string target_name;
+  DirRef target_dir = openParent(target, target_name, false);
+  if (!target_dir) {
+    throw std::runtime_error("Failed to link " + path + ": " +
+                             strerror(ENOENT));
+  }
+
+  std::string name;
+  DirRef dir = openParent(path, name);
+  int r = createReplacing(dir, path, name, [&]() {
+    return linkat(target_dir->fd, target_name.c_str(), dir->fd, name.c_str(),
+                  0);
+  });
+  int err = errno;
+  if (r != 0) {
+    throw std::runtime_error("Failed to link " + path + ": " + strerror(err));
+  }
+}
+
+void TreeWriter::special(const std::string& path, mode_t mode, dev_t rdev) {
+  waitPath(path);
+
+  std::string name;
+  DirRef dir = openParent(path, name);
+  int r = createReplacing(dir, path, name, [&dir, &name, mode, rdev]() {
+    return mknodat(dir->fd, name.c_str(), mode & (S_IFMT | 01777), rdev);
+  });
+  int err = errno;
+  if (r != 0) {
+    throw std::runtime_error("Failed to create " + path + ": " +
+                             strerror(err));
+  }
+}
+
+bool TreeWriter::adopt(const std::string& path, int fd) {
+  waitPath(path);
+
+  std::string name;
+  DirRef dir = openParent(path, name);
+  int r = createReplacing(dir, path, name, [&dir, &name, fd]() {
+    return linkat(fd, "", dir->fd, name.c_str(), AT_EMPTY_PATH);
+  });
+  if (r != 0 && (errno == EPERM || errno == ENOENT)) {
+    // AT_EMPTY_PATH 권한이 없으면 /proc의 fd link 사용
+    std::string proc = "/proc/self/fd/" + std::to_string(fd);
+    r = linkat(AT_FDCWD, proc.c_str(), dir->fd, name.c_str(),
+               AT_SYMLINK_FOLLOW);
+  }
+  return r == 0;
+}
+
+void TreeWriter::remove(const std::string& path) {
+  waitAll();
+
+  std::string name;
+  DirRef dir = openParent(path, name, false);
+  if (dir && removeAt(dir->fd, name)) {
+    invalidate(path);
+  }
+}
+
+void TreeWriter::finish() {
+  waitAll();
+
+  // 하위 directory부터 (역순 정렬 시 "a/b"가 "a"보다 앞)
+  std::sort(dirModes.begin(), dirModes.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+  for (const auto& dir_mode : dirModes) {
+    std::string name;
+    DirRef dir = openParent(dir_mode.first, name, false);
+    if (!dir) {
+      continue;
+    }
+    int fd = openat(dir->fd, name.c_str(),
+                    O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd >= 0) {
+      fchmod(fd, dir_mode.second & 01777);
+      close(fd);
+    }
+  }
+  dirModes.clear();
+}
+
+}  // namespace utils
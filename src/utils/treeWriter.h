@@ -0,0 +1,154 @@
+#pragma once
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ioBatch.h"
+#include "threadPool.h"
+
+namespace utils {
+
+// Archive entry를 directory tree로 기록 (extract의 disk 쓰기 단계)
+// 호출한 thread는 data를 pool buffer(최대 EXTRACT_MEMORY)에 복사만 하고
+// writer thread들이 file 생성/pwrite/fchmod를 병렬로 처리하므로 해제와
+// file 생성이 겹침. Directory/link 등은 호출한 thread에서 바로 생성
+//
+// 순서 보장: 같은 경로의 이전 file이 끝난 뒤 다음 entry 처리, 없는
+// 상위 directory는 자동 생성, directory mode는 finish()에서 하위부터 적용
+// 경로는 root 기준 상대 경로이며 component마다 O_NOFOLLOW로 열어
+// symlink를 통해 root 밖에 쓰지 않음. 연 directory fd는 LRU cache
+// (EXTRACT_DIR_CACHE개)에 두고 child는 openat으로 생성하므로 entry마다
+// 경로 전체를 다시 찾지 않음
+// 이미 있는 entry는 삭제 후 새로 생성 (hardlink된 file을 덮어쓰지 않음)
+//
+// Data는 EXTRACT_CHUNK_SIZE 단위로 모아 기록하고, 크기를 아는 file은
+// fallocate로 미리 할당 (sparse file 제외). EXTRACT_DIRECT_MIN 이상은
+// 정렬된 chunk를 O_DIRECT로 쓰고 끝의 정렬되지 않은 부분만 buffered
+// IO_BATCH_FILE_MAX 이하의 작은 file은 IO_BATCH_FILES개씩 모아 writer
+// thread 하나가 create/write/close를 단계별로 한 번에 요청 (IoBatch)
+class TreeWriter {
+ public:
+  // root: 이미 존재하는 directory
+  TreeWriter(const std::string& root, size_t threads);
+  ~TreeWriter();
+
+  TreeWriter(const TreeWriter&) = delete;
+  TreeWriter& operator=(const TreeWriter&) = delete;
+
+  void directory(const std::string& path, mode_t mode);
+
+  // Regular file: beginFile, write (offset 순, 여러 번), endFile
+  // size: 최종 크기 (할당/buffer 크기), mtime: tv_nsec가 UTIME_OMIT이면 유지
+  // sparse: hole이 있는 file (미리 할당하지 않음)
+  void beginFile(const std::string& path, mode_t mode, uint64_t size,
+                 timespec mtime = {0, UTIME_OMIT}, bool sparse = false);
+  void write(const void* data, size_t len, int64_t offset);
+  void endFile();
+
+  void symlink(const std::string& path, const std::string& target);
+  void hardlink(const std::string& path, const std::string& target);
+  void special(const std::string& path, mode_t mode, dev_t rdev);
+
+  // 열려 있는 기존 file(root 밖 가능, 같은 filesystem)을 path에 hardlink
+  // 실패하면 false (caller가 data를 기록)
+  bool adopt(const std::string& path, int fd);
+
+  // 진행 중인 쓰기가 모두 끝난 뒤 path(subtree 포함) 삭제
+  void remove(const std::string& path);
+
+  // 모든 쓰기 완료 대기 후 directory mode 적용 (writer 오류는 예외)
+  void finish();
+
+ private:
+  struct Chunk {
+    int64_t offset = 0;
+    std::vector<char> data;
+  };
+
+  // 열어 둔 directory (마지막 참조가 사라질 때 close)
+  struct DirFd {
+    explicit DirFd(int fd) : fd(fd) {}
+    ~DirFd();
+    int fd;
+  };
+  using DirRef = std::shared_ptr<DirFd>;
+
+  struct FileJob {
+    std::string path;
+    mode_t mode = 0;
+    uint64_t size = 0;
+    bool sparse = false;
+    timespec mtime = {0, UTIME_OMIT};
+    std::deque<Chunk> chunks;
+    bool complete = false;  // 더 추가될 chunk 없음
+  };
+
+  // parts[0, count) directory (create가 false면 없을 때 nullptr)
+  DirRef openDir(const std::vector<std::string>& parts, size_t count,
+                 bool create);
+  // path의 상위 directory, name에는 마지막 component
+  DirRef openParent(const std::string& path, std::string& name,
+                    bool create = true);
+  // path 아래 cache 제거 (directory가 삭제/교체된 경우)
+  void invalidate(const std::string& path);
+  // create가 EEXIST로 실패하면 기존 entry를 지우고 한 번 더 시도
+  template <typename Create>
+  int createReplacing(const DirRef& dir, const std::string& path,
+                      const std::string& name, Create create);
+
+  void submitCurrent();
+  void flushPending();
+  void flushBatch();
+  void writeFile(const std::shared_ptr<FileJob>& job);
+  void writeBatch(const std::vector<std::shared_ptr<FileJob>>& jobs);
+  void finishJob(const std::shared_ptr<FileJob>& job,
+                 const std::string& failure);
+  void release(std::vector<char>& buffer);
+  void waitPath(const std::string& path);
+  void waitAll();
+  void checkError();
+
+  DirRef rootDir;
+
+  // key: 정규화된 상대 경로, lru 앞쪽이 최근 사용
+  std::mutex cacheMutex;
+  std::list<std::string> lru;
+  std::unordered_map<std::string,
+                     std::pair<DirRef, std::list<std::string>::iterator>>
+      dirCache;
+
+  std::mutex mutex;
+  std::condition_variable dataCv;    // chunk 추가 (writer 대기)
+  std::condition_variable memoryCv;  // buffer 반환 (호출 thread 대기)
+  std::condition_variable doneCv;    // file 완료 (호출 thread 대기)
+
+  std::unordered_map<std::string, std::shared_ptr<FileJob>> inflight;
+  size_t running = 0;  // 제출했지만 끝나지 않은 file 수
+  std::vector<std::vector<char>> pool;  // 재사용 buffer (EXTRACT_CHUNK_SIZE)
+  size_t memoryUsed = 0;
+  std::string error;  // 첫 writer 오류
+  bool aborted = false;
+
+  // 호출 thread 상태
+  std::shared_ptr<FileJob> current;
+  bool submitted = false;
+  uint64_t remaining = 0;  // 현재 file의 예상 남은 크기
+  Chunk pending;           // 아직 job에 넘기지 않은 data
+  std::vector<std::shared_ptr<FileJob>> batch;  // 제출 전 작은 file
+  std::vector<std::pair<std::string, mode_t>> dirModes;
+
+  std::unique_ptr<ThreadPool> writers;  // 마지막에 생성, 처음에 정리
+};
+
+}  // namespace utils
@@ -1,11 +1,16 @@
 #include "utils.h"
 
-#include <sys/socket.h>
+#include <plog/Log.h>
 
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <filesystem>
 #include <stdexcept>
 
 #include "config.h"
+#include "httpResponse.h"
 
 namespace fs = std::filesystem;
 
@@ -21,10 +26,20 @@ std::string extractJson(const std::string& json, const std::string& key) {
   if (pos == std::string::npos) {
     return "";
   }
-  pos = json.find("\"", pos);
+  pos = json.find_first_not_of(" \t\r\n", pos + 1);
   if (pos == std::string::npos) {
     return "";
   }
+
+  // 숫자/boolean 값
+  if (json[pos] != '"') {
+    size_t end = json.find_first_of(",} \t\r\n", pos);
+    if (end == std::string::npos) {
+      end = json.size();
+    }
+    return json.substr(pos, end - pos);
+  }
+
   size_t end = json.find("\"", pos + 1);
   if (end == std::string::npos) {
     return "";
@@ -32,24 +47,90 @@ std::string extractJson(const std::string& json, const std::string& key) {
   return json.substr(pos + 1, end - pos - 1);
 }
 
+// JSON string escape
+std::string jsonEscape(const std::string& str) {
+  std::string out;
+  out.reserve(str.size());
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          snprintf(buf, sizeof(buf), "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out;
+}
+
 // JSON response 생성
 std::string jsonMsg(bool ok, const std::string& msg) {
   if (ok) {
-    return R"({"success":true,"message":")" + msg + R"("})";
+    return R"({"success":true,"message":")" + jsonEscape(msg) + R"("})";
   }
-  return R"({"success":false,"message":")" + msg + R"("})";
+  return R"({"success":false,"message":")" + jsonEscape(msg) + R"("})";
 }
 
-// User validation
-std::string validateUser(const std::string& body) {
-  std::string user = extractJson(body, "user");
+// Query string value 추출 (percent-decoding 포함)
+std::string queryParam(const std::string& query, const std::string& key) {
+  size_t pos = 0;
+  while (pos <= query.size()) {
+    size_t end = query.find('&', pos);
+    if (end == std::string::npos) {
+      end = query.size();
+    }
+
+    size_t eq = query.find('=', pos);
+    if (eq != std::string::npos && eq < end &&
+        query.compare(pos, eq - pos, key) == 0) {
+      std::string value;
+      for (size_t i = eq + 1; i < end; ++i) {
+        char c = query[i];
+        if (c == '+') {
+          value += ' ';
+        } else if (c == '%' && i + 2 < end && isxdigit(query[i + 1]) &&
+                   isxdigit(query[i + 2])) {
+          value += static_cast<char>(
+              std::stoi(query.substr(i + 1, 2), nullptr, 16));
+          i += 2;
+        } else {
+          value += c;
+        }
+      }
+      return value;
+    }
+
+    pos = end + 1;
+  }
+  return "";
+}
 
+// User validation
+std::string checkUser(const std::string& user) {
   if (user.empty()) {
     throw std::invalid_argument("Missing user field");
   }
 
-  // Path traversal 방지
-  if (user.find("..") != std::string::npos ||
+  // Path traversal 방지 ('.'으로 시작하는 이름은 chunk store 등 내부용)
+  if (user[0] == '.' || user.find("..") != std::string::npos ||
       user.find("/") != std::string::npos) {
     throw std::invalid_argument("Invalid user");
   }
@@ -61,30 +142,48 @@ std::string validateUser(const std::string& body) {
   return user;
 }
 
-// HTTP response 전송
-void sendHttpResponse(int socket, int status, const std::string& body) {
-  const char* text;
-
-  if (status == 200) {
-    text = "OK";
-  } else if (status == 400) {
-    text = "Bad Request";
-  } else if (status == 401) {
-    text = "Unauthorized";
-  } else if (status == 404) {
-    text = "Not Found";
-  } else {
-    text = "Internal Server Error";
+std::string validateUser(const std::string& body) {
+  return checkUser(extractJson(body, "user"));
+}
+
+bool parseChunkSize(const char* line, size_t len, uint64_t& size) {
+  size = 0;
+  size_t i = 0;
+  for (; i < len && isxdigit(static_cast<unsigned char>(line[i])); ++i) {
+    if (size > (UINT64_MAX >> 4)) {
+      return false;
+    }
+    char c = line[i];
+    int digit = c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10;
+    size = (size << 4) | static_cast<uint64_t>(digit);
+  }
+  if (i == 0) {
+    return false;
   }
 
-  std::string response = "HTTP/1.1 " + std::to_string(status) + " " + text +
-                         "\r\n"
-                         "Content-Type: application/json\r\n"
-                         "Content-Length: " +
-                         std::to_string(body.length()) + "\r\n\r\n" + body;
+  while (i < len && (line[i] == ' ' || line[i] == '\t')) {
+    ++i;
+  }
+  return i == len || line[i] == ';';
+}
+
+// 전체 buffer 전송 (partial write 처리)
+void sendAll(int socket, const char* data, size_t len) {
+  iovec iov = {const_cast<char*>(data), len};
+  sendAllv(socket, &iov, 1);
+}
 
-  // MSG_NOSIGNAL: SIGPIPE 방지
-  send(socket, response.c_str(), response.length(), MSG_NOSIGNAL);
+// HTTP response 전송 (body는 복사하지 않음)
+// 전송 실패는 이후 socket read/write에서 connection 종료로 처리됨
+void sendHttpResponse(int socket, int status, const std::string& body) {
+  try {
+    HttpResponse(status)
+        .header("Content-Type", "application/json")
+        .body(body.data(), body.size())
+        .send(socket);
+  } catch (const std::exception& e) {
+    PLOGW << "Failed to send response: " << e.what();
+  }
 }
 
 }  // namespace utils
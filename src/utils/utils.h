@@ -1,12 +1,21 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace utils {
 
 std::string extractJson(const std::string& json, const std::string& key);
+std::string jsonEscape(const std::string& str);
 std::string jsonMsg(bool ok, const std::string& msg);
+std::string queryParam(const std::string& query, const std::string& key);
+std::string checkUser(const std::string& user);
 std::string validateUser(const std::string& body);
+void sendAll(int socket, const char* data, size_t len);
+// Chunked body의 chunk-size 줄 (CRLF 제외) 검사
+// 16진수 뒤에는 공백/tab과 chunk-ext(;...)만 허용, overflow는 실패
+bool parseChunkSize(const char* line, size_t len, uint64_t& size);
 void sendHttpResponse(int socket, int status, const std::string& body);
 
 }  // namespace utils